@@ -6,6 +6,7 @@
 #include <stack>
 #include <iomanip>
 #include <algorithm>
+#include "../DFA_MINIMIZE.h"
 using namespace std;
 
 enum Type
@@ -226,12 +227,13 @@ struct StateCmp
     bool operator()(const State &a, const State &b) const { return a < b; }
 };
 
-char symbol_at(int pos, const vector<Node *> &leaves)
+// Symbol of every position (index 0 unused), so a lookup is one load
+vector<char> position_symbols(const vector<Node *> &leaves)
 {
+    vector<char> symbol(leaves.size() + 1, 0);
     for (auto *leaf : leaves)
-        if (leaf->position == pos)
-            return leaf->symbol;
-    return 0;
+        symbol[leaf->position] = leaf->symbol;
+    return symbol;
 }
 
 void construct_dfa(Node *root, const vector<Node *> &leaves, const map<int, set<int>> &followpos,
@@ -240,78 +242,43 @@ void construct_dfa(Node *root, const vector<Node *> &leaves, const map<int, set<
 {
     vector<State> states;
     map<State, int, StateCmp> state_ids;
-    vector<bool> is_marked;
+    vector<char> symbol = position_symbols(leaves);
 
     State start = root->firstpos;
     states.push_back(start);
     state_ids[start] = 0;
-    is_marked.push_back(false);
+    dfa_trans.assign(1, map<char, int>());
 
     int marker_pos = -1;
     for (auto *leaf : leaves)
         if (leaf->symbol == '#')
             marker_pos = leaf->position;
 
-    while (true)
+    // Worklist: states[next..] are unmarked. Each state is expanded once and
+    // its transitions are filled in as its successors are found.
+    for (size_t next = 0; next < states.size(); ++next)
     {
-        int i = -1;
-        for (size_t j = 0; j < states.size(); ++j)
-            if (!is_marked[j])
-            {
-                i = int(j);
-                break;
-            }
-        if (i == -1)
-            break;
-        is_marked[i] = true;
-        State T = states[i];
-        map<char, State> move_map;
-        for (int p : T)
+        map<char, State> move_map; // symbol -> union of followpos
+        for (int p : states[next])
         {
-            char a = symbol_at(p, leaves);
+            char a = symbol[p];
             if (a == '#')
                 continue;
-            move_map[a].insert(p);
+            move_map[a].insert(followpos.at(p).begin(), followpos.at(p).end());
         }
-        for (auto pr : move_map)
+        for (auto &pr : move_map)
         {
-            char a = pr.first;
-            State U;
-            for (int p : pr.second)
-                U.insert(followpos.at(p).begin(), followpos.at(p).end());
-            if (!state_ids.count(U))
+            auto found = state_ids.emplace(pr.second, int(states.size()));
+            if (found.second)
             {
-                state_ids[U] = int(states.size());
-                states.push_back(U);
-                is_marked.push_back(false);
+                states.push_back(pr.second);
+                dfa_trans.emplace_back();
             }
+            dfa_trans[next][pr.first] = found.first->second;
         }
     }
 
     dfa_states = state_ids;
-    dfa_trans = vector<map<char, int>>(states.size());
-    for (size_t i = 0; i < states.size(); ++i)
-    {
-        State T = states[i];
-        map<char, State> move_map;
-        for (int p : T)
-        {
-            char a = symbol_at(p, leaves);
-            if (a == '#')
-                continue;
-            move_map[a].insert(p);
-        }
-        for (auto pr : move_map)
-        {
-            char a = pr.first;
-            State U;
-            for (int p : pr.second)
-                U.insert(followpos.at(p).begin(), followpos.at(p).end());
-            int id = state_ids[U];
-            dfa_trans[i][a] = id;
-        }
-    }
-
     for (auto pr : dfa_states)
     {
         State T = pr.first;
@@ -394,8 +361,84 @@ void print_dfa(const map<State, int, StateCmp> &dfa_states,
     }
 }
 
-int main()
+// Hopcroft-minimizes the DFA and prints it; every state holding the end
+// marker accepts. "Merges" lists the raw states each new state replaces.
+void print_minimized_dfa(const map<State, int, StateCmp> &dfa_states,
+                         const vector<map<char, int>> &dfa_trans, const vector<Node *> &leaves)
+{
+    set<char> symbols;
+    int marker_pos = -1;
+    for (auto *leaf : leaves)
+    {
+        if (leaf->symbol == '#')
+            marker_pos = leaf->position;
+        else
+            symbols.insert(leaf->symbol);
+    }
+    vector<char> alphabet(symbols.begin(), symbols.end());
+
+    vector<vector<int>> trans(dfa_trans.size(), vector<int>(alphabet.size(), -1));
+    vector<bool> accepting(dfa_trans.size());
+    for (auto pr : dfa_states)
+        accepting[pr.second] = pr.first.count(marker_pos);
+    for (size_t id = 0; id < dfa_trans.size(); ++id)
+        for (size_t c = 0; c < alphabet.size(); ++c)
+            if (dfa_trans[id].count(alphabet[c]))
+                trans[id][c] = dfa_trans[id].at(alphabet[c]);
+    MinimizedDFA m = hopcroft_minimize(trans, accepting, 0);
+
+    cout << "\nMinimized DFA Transition Table: -------------\n";
+    cout << left << setw(10) << "State" << setw(20) << "Merges";
+    for (char a : alphabet)
+        cout << setw(8) << a;
+    cout << "Accept\n";
+    cout << string(10 + 20 + 8 * alphabet.size() + 8, '-') << "\n";
+
+    for (int id = 0; id < m.size(); ++id)
+    {
+        set<int> merged;
+        for (size_t s = 0; s < m.class_of.size(); ++s)
+            if (m.class_of[s] == id)
+                merged.insert(int(s));
+        string label = (id == m.start ? "->" : "  ") + to_string(id) + (m.accepting[id] ? "*" : "");
+
+        cout << left << setw(10) << label;
+        print_set(merged);
+        int width = 2 + (merged.empty() ? 0 : int(merged.size()) - 1); // braces and commas
+        for (int x : merged)
+            width += to_string(x).length();
+        int pad = 20 - width;
+        if (pad < 0)
+            pad = 0;
+        cout << string(pad, ' ');
+
+        for (size_t c = 0; c < alphabet.size(); ++c)
+        {
+            if (m.trans[id][c] >= 0)
+                cout << setw(8) << m.trans[id][c];
+            else
+                cout << setw(8) << "-";
+        }
+        cout << (m.accepting[id] ? "Yes" : "No") << "\n";
+    }
+
+    int dropped = 0;
+    for (int c : m.class_of)
+        dropped += c < 0;
+    cout << "\nMinimized: " << m.class_of.size() << " -> " << m.size() << " states ("
+         << m.class_of.size() - m.size() << " fewer";
+    if (dropped)
+        cout << ", " << dropped << " of them dead";
+    cout << ")\n";
+}
+
+int main(int argc, char *argv[])
 {
+    bool minimize = false; // --minimize: also print the Hopcroft-minimized table
+    for (int a = 1; a < argc; a++)
+        if (string(argv[a]) == "--minimize")
+            minimize = true;
+
     cout << "Enter regular expression (without dots, ending with #): ";
 
     string input;
@@ -422,6 +465,8 @@ int main()
     construct_dfa(root, leaves, followpos, dfa_states, dfa_trans, accept_state);
 
     print_dfa(dfa_states, dfa_trans, accept_state, leaves);
+    if (minimize)
+        print_minimized_dfa(dfa_states, dfa_trans, leaves);
 
     return 0;
 }
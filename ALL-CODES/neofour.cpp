@@ -5,10 +5,12 @@
 #include <stack>
 #include <algorithm>
 #include <memory>
+#include "../DFA_MINIMIZE.h"
 using namespace std;
 
 const char EPSILON = '@';  // Using @ to represent epsilon
 const char END_MARKER = '#';  // Standard end marker
+bool minimizeDFA = false;     // --minimize: also print the Hopcroft-minimized DFA
 
 struct Node {
     char val;
@@ -194,6 +196,60 @@ void calculateFollowPos(Node* node, map<int, set<int>>& followpos) {
     calculateFollowPos(node->right.get(), followpos);
 }
 
+void printMinimizedDFA(const vector<set<int>>& states, const map<pair<set<int>, char>, set<int>>& transition,
+                       const set<set<int>>& acceptingStates, const map<int, char>& posToChar) {
+    set<char> symbols;
+    for(auto& entry : posToChar) {
+        if(entry.second != END_MARKER) symbols.insert(entry.second);
+    }
+    vector<char> alphabet(symbols.begin(), symbols.end());
+    
+    auto indexOf = [&](const set<int>& state) {
+        return int(distance(states.begin(), find(states.begin(), states.end(), state)));
+    };
+    vector<vector<int>> trans(states.size(), vector<int>(alphabet.size(), -1));
+    vector<bool> accepting(states.size());
+    for(size_t i = 0; i < states.size(); ++i) {
+        accepting[i] = acceptingStates.count(states[i]);
+    }
+    for(auto& entry : transition) {
+        int c = int(lower_bound(alphabet.begin(), alphabet.end(), entry.first.second) - alphabet.begin());
+        trans[indexOf(entry.first.first)][c] = indexOf(entry.second);
+    }
+    MinimizedDFA m = hopcroft_minimize(trans, accepting, 0);
+    
+    cout << "\nMinimized DFA States:\n";
+    for(int id = 0; id < m.size(); ++id) {
+        set<int> merged;
+        for(size_t i = 0; i < m.class_of.size(); ++i) {
+            if(m.class_of[i] == id) merged.insert(int(i));
+        }
+        cout << "State " << id << ": merges ";
+        printSet(merged);
+        if(m.accepting[id]) {
+            cout << " (accepting)";
+        }
+        cout << endl;
+    }
+    
+    cout << "\nMinimized Transition Table:\n";
+    cout << "State\tSymbol\tNext State\n";
+    for(int id = 0; id < m.size(); ++id) {
+        for(size_t c = 0; c < alphabet.size(); ++c) {
+            if(m.trans[id][c] >= 0) {
+                cout << id << "\t" << alphabet[c] << "\t" << m.trans[id][c] << endl;
+            }
+        }
+    }
+    
+    int dropped = 0;
+    for(int c : m.class_of) dropped += c < 0;
+    cout << "\nMinimized: " << states.size() << " -> " << m.size() << " states ("
+         << states.size() - m.size() << " fewer";
+    if(dropped) cout << ", " << dropped << " of them dead";
+    cout << ")" << endl;
+}
+
 void constructDFA(unique_ptr<Node>& root, const map<int, char>& posToChar, const map<int, set<int>>& followpos) {
     set<int> startState = root->firstpos;
     vector<set<int>> states = {startState};
@@ -260,6 +316,10 @@ void constructDFA(unique_ptr<Node>& root, const map<int, char>& posToChar, const
         cout << distance(states.begin(), fromIt) << "\t" << symbol << "\t" 
              << distance(states.begin(), toIt) << endl;
     }
+    
+    if(minimizeDFA) {
+        printMinimizedDFA(states, transition, acceptingStates, posToChar);
+    }
 }
 
 void processRegex(const string& regex) {
@@ -292,7 +352,11 @@ void processRegex(const string& regex) {
     constructDFA(root, posToChar, followpos);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    for(int a = 1; a < argc; a++) {
+        if(string(argv[a]) == "--minimize") minimizeDFA = true;
+    }
+    
     // Test cases
     cout << "Testing simple patterns first...\n";
     // processRegex("ab");
@@ -3,20 +3,38 @@
 #include <string.h>
 #include <ctype.h>
 
-#define MAX_LEXEME 100
-#define MAX_ENTRIES 1000
+// Lexemes are interned into an arena of chained blocks: each distinct
+// lexeme is stored once and symbols point at it
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+typedef struct ArenaBlock
+{
+    struct ArenaBlock *next;
+    size_t used, capacity;
+    char data[];
+} ArenaBlock;
+
+ArenaBlock *arena = NULL;
 
 typedef struct
 {
-    char lexeme[MAX_LEXEME];
-    char tokenType[20];
+    const char *lexeme; // interned
+    const char *tokenType;
     int declaredLine;
-    int usedLines[100];
-    int useCount;
+    int *usedLines;
+    int useCount, useCapacity;
 } Symbol;
 
-Symbol symbolTable[MAX_ENTRIES];
-int symbolCount = 0;
+// Symbols in first-occurrence order, grown by doubling
+Symbol *symbolTable = NULL;
+int symbolCount = 0, symbolCapacity = 0;
+
+// Open-addressing indexes (power-of-two sizes, load factor under 1/2):
+// internSlots holds interned strings, symbolSlots holds symbol index + 1
+const char **internSlots = NULL;
+size_t internCount = 0, internCapacity = 0;
+int *symbolSlots = NULL;
+size_t symbolSlotCapacity = 0;
 
 const char *keywords[] = {
     "int", "float", "char", "return", "void", "if", "else", "while", "for", "do", "switch", "case", "break", "continue"};
@@ -43,22 +61,167 @@ int isSpecialSymbol(char ch)
     return strchr(specialSymbols, ch) != NULL;
 }
 
-int addToSymbolTable(const char *lexeme, const char *tokenType, int line, int isDeclaration)
+void *xmalloc(size_t n)
+{
+    void *p = malloc(n);
+    if (!p)
+    {
+        perror("Memory allocation failed");
+        exit(1);
+    }
+    return p;
+}
+
+void *xcalloc(size_t n, size_t size)
+{
+    void *p = calloc(n, size);
+    if (!p)
+    {
+        perror("Memory allocation failed");
+        exit(1);
+    }
+    return p;
+}
+
+void *xrealloc(void *p, size_t n)
+{
+    p = realloc(p, n);
+    if (!p)
+    {
+        perror("Memory allocation failed");
+        exit(1);
+    }
+    return p;
+}
+
+const char *arenaStrndup(const char *s, size_t len)
+{
+    if (!arena || arena->used + len + 1 > arena->capacity)
+    {
+        size_t capacity = len + 1 > ARENA_BLOCK_SIZE ? len + 1 : ARENA_BLOCK_SIZE;
+        ArenaBlock *block = xmalloc(sizeof(ArenaBlock) + capacity);
+        block->next = arena;
+        block->used = 0;
+        block->capacity = capacity;
+        arena = block;
+    }
+    char *dst = arena->data + arena->used;
+    memcpy(dst, s, len);
+    dst[len] = '\0';
+    arena->used += len + 1;
+    return dst;
+}
+
+// FNV-1a
+size_t hashBytes(const char *s, size_t len)
 {
+    size_t h = 14695981039346656037ULL;
+    for (size_t k = 0; k < len; k++)
+    {
+        h ^= (unsigned char)s[k];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Interned copy of s[0..len)
+const char *intern(const char *s, size_t len)
+{
+    if (internCount * 2 >= internCapacity)
+    {
+        size_t capacity = internCapacity ? internCapacity * 2 : 1024;
+        const char **slots = xcalloc(capacity, sizeof(const char *));
+        for (size_t k = 0; k < internCapacity; k++)
+        {
+            if (!internSlots[k])
+                continue;
+            size_t slot = hashBytes(internSlots[k], strlen(internSlots[k])) & (capacity - 1);
+            while (slots[slot])
+                slot = (slot + 1) & (capacity - 1);
+            slots[slot] = internSlots[k];
+        }
+        free(internSlots);
+        internSlots = slots;
+        internCapacity = capacity;
+    }
+
+    size_t mask = internCapacity - 1;
+    size_t slot = hashBytes(s, len) & mask;
+    while (internSlots[slot])
+    {
+        if (strncmp(internSlots[slot], s, len) == 0 && internSlots[slot][len] == '\0')
+            return internSlots[slot];
+        slot = (slot + 1) & mask;
+    }
+    internCount++;
+    return internSlots[slot] = arenaStrndup(s, len);
+}
+
+// Interned lexemes are unique, so symbols are hashed by pointer
+size_t symbolHash(const char *lexeme)
+{
+    size_t h = (size_t)lexeme * 0x9E3779B97F4A7C15ULL;
+    return h ^ (h >> 29);
+}
+
+void growSymbolSlots(void)
+{
+    size_t capacity = symbolSlotCapacity ? symbolSlotCapacity * 2 : 1024;
+    int *slots = xcalloc(capacity, sizeof(int));
     for (int i = 0; i < symbolCount; i++)
     {
-        if (strcmp(symbolTable[i].lexeme, lexeme) == 0)
+        size_t slot = symbolHash(symbolTable[i].lexeme) & (capacity - 1);
+        while (slots[slot])
+            slot = (slot + 1) & (capacity - 1);
+        slots[slot] = i + 1;
+    }
+    free(symbolSlots);
+    symbolSlots = slots;
+    symbolSlotCapacity = capacity;
+}
+
+void addUse(Symbol *sym, int line)
+{
+    if (sym->useCount == sym->useCapacity)
+    {
+        sym->useCapacity = sym->useCapacity ? sym->useCapacity * 2 : 4;
+        sym->usedLines = xrealloc(sym->usedLines, sym->useCapacity * sizeof(int));
+    }
+    sym->usedLines[sym->useCount++] = line;
+}
+
+// lexeme must be interned
+int addToSymbolTable(const char *lexeme, const char *tokenType, int line, int isDeclaration)
+{
+    if ((size_t)symbolCount * 2 >= symbolSlotCapacity)
+        growSymbolSlots();
+
+    size_t mask = symbolSlotCapacity - 1;
+    size_t slot = symbolHash(lexeme) & mask;
+    while (symbolSlots[slot])
+    {
+        int i = symbolSlots[slot] - 1;
+        if (symbolTable[i].lexeme == lexeme)
         {
-            symbolTable[i].usedLines[symbolTable[i].useCount++] = line;
+            addUse(&symbolTable[i], line);
             return i;
         }
+        slot = (slot + 1) & mask;
     }
 
-    strcpy(symbolTable[symbolCount].lexeme, lexeme);
-    strcpy(symbolTable[symbolCount].tokenType, tokenType);
-    symbolTable[symbolCount].declaredLine = isDeclaration ? line : -1;
-    symbolTable[symbolCount].usedLines[0] = line;
-    symbolTable[symbolCount].useCount = 1;
+    if (symbolCount == symbolCapacity)
+    {
+        symbolCapacity = symbolCapacity ? symbolCapacity * 2 : 256;
+        symbolTable = xrealloc(symbolTable, symbolCapacity * sizeof(Symbol));
+    }
+    Symbol *sym = &symbolTable[symbolCount];
+    sym->lexeme = lexeme;
+    sym->tokenType = tokenType;
+    sym->declaredLine = isDeclaration ? line : -1;
+    sym->usedLines = NULL;
+    sym->useCount = sym->useCapacity = 0;
+    addUse(sym, line);
+    symbolSlots[slot] = symbolCount + 1;
     return symbolCount++;
 }
 
@@ -99,13 +262,18 @@ void analyze(const char *filename)
         exit(1);
     }
 
-    char buffer[10000];
-    fread(buffer, sizeof(char), sizeof(buffer), file);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    // zero padding: the char literal checks look up to two bytes ahead
+    char *buffer = xcalloc(size + 3, 1);
+    fread(buffer, sizeof(char), size, file);
     fclose(file);
 
     removeComments(buffer);
 
-    int i = 0, line = 1;
+    long i = 0;
+    int line = 1;
     while (buffer[i])
     {
         if (isspace(buffer[i]))
@@ -118,28 +286,24 @@ void analyze(const char *filename)
 
         if (isalpha(buffer[i]) || buffer[i] == '_')
         {
-            char temp[MAX_LEXEME];
-            int j = 0;
+            long start = i;
             while (isalnum(buffer[i]) || buffer[i] == '_')
-            {
-                temp[j++] = buffer[i++];
-            }
-            temp[j] = '\0';
+                i++;
+            const char *lexeme = intern(buffer + start, i - start);
 
-            if (isKeyword(temp))
+            if (isKeyword(lexeme))
             {
-                printf("[KEYWORD: %s] at line %d\n", temp, line);
+                printf("[KEYWORD: %s] at line %d\n", lexeme, line);
             }
             else
             {
-                printf("[IDENTIFIER: %s] at line %d\n", temp, line);
-                addToSymbolTable(temp, "IDENTIFIER", line, 1);
+                printf("[IDENTIFIER: %s] at line %d\n", lexeme, line);
+                addToSymbolTable(lexeme, "IDENTIFIER", line, 1);
             }
         }
         else if (isdigit(buffer[i]))
         {
-            char temp[MAX_LEXEME];
-            int j = 0;
+            long start = i;
             int hasDecimal = 0;
             while (isdigit(buffer[i]) || buffer[i] == '.')
             {
@@ -148,31 +312,28 @@ void analyze(const char *filename)
                     if (hasDecimal++)
                         break; // error: more than 1 dot
                 }
-                temp[j++] = buffer[i++];
+                i++;
             }
-            temp[j] = '\0';
+            const char *lexeme = intern(buffer + start, i - start);
             if (hasDecimal)
-                printf("[FLOAT: %s] at line %d\n", temp, line);
+                printf("[FLOAT: %s] at line %d\n", lexeme, line);
             else
-                printf("[INTEGER: %s] at line %d\n", temp, line);
+                printf("[INTEGER: %s] at line %d\n", lexeme, line);
 
-            addToSymbolTable(temp, hasDecimal ? "FLOAT" : "INTEGER", line, 0);
+            addToSymbolTable(lexeme, hasDecimal ? "FLOAT" : "INTEGER", line, 0);
         }
         else if (buffer[i] == '"')
         {
             i++;
-            char temp[MAX_LEXEME];
-            int j = 0;
+            long start = i;
             while (buffer[i] && buffer[i] != '"')
-            {
-                temp[j++] = buffer[i++];
-            }
-            temp[j] = '\0';
+                i++;
             if (buffer[i] == '"')
             {
+                const char *lexeme = intern(buffer + start, i - start);
                 i++;
-                printf("[LITERAL: \"%s\"] at line %d\n", temp, line);
-                addToSymbolTable(temp, "LITERAL", line, 0);
+                printf("[LITERAL: \"%s\"] at line %d\n", lexeme, line);
+                addToSymbolTable(lexeme, "LITERAL", line, 0);
             }
             else
             {
@@ -182,25 +343,18 @@ void analyze(const char *filename)
         else if (buffer[i] == '\'')
         {
             i++;
-            char temp[MAX_LEXEME];
-            int j = 0;
-
+            int len = 0;
             if (buffer[i] && buffer[i + 1] == '\'')
-            {
-                temp[j++] = buffer[i++];
-                i++; // skip closing '
-                temp[j] = '\0';
-                printf("[CHAR_LITERAL: '%s'] at line %d\n", temp, line);
-                addToSymbolTable(temp, "CHAR_LITERAL", line, 0);
-            }
+                len = 1;
             else if (buffer[i] == '\\' && buffer[i + 2] == '\'')
+                len = 2;
+
+            if (len)
             {
-                temp[j++] = buffer[i++];
-                temp[j++] = buffer[i++];
-                i++; // skip closing '
-                temp[j] = '\0';
-                printf("[CHAR_LITERAL: '%s'] at line %d\n", temp, line);
-                addToSymbolTable(temp, "CHAR_LITERAL", line, 0);
+                const char *lexeme = intern(buffer + i, len);
+                i += len + 1; // skip closing '
+                printf("[CHAR_LITERAL: '%s'] at line %d\n", lexeme, line);
+                addToSymbolTable(lexeme, "CHAR_LITERAL", line, 0);
             }
             else
             {
@@ -227,6 +381,7 @@ void analyze(const char *filename)
             i++;
         }
     }
+    free(buffer);
 
     printf("\n=== SYMBOL TABLE ===\n");
     printf("Entry No.\tLexeme\t\tToken Type\t\tLine No. Declared\tLine No. Used\n");
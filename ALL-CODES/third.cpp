@@ -2,23 +2,44 @@
 #include <fstream>
 #include <sstream>
 #include <regex>
-#include <unordered_set>
 #include <vector>
 #include <iomanip>
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <chrono>
+#include "../OPERATOR_TRIE.h"
+#include "../LEX_TABLES.h"
 using namespace std;
 
 // ---------- Lexical Rules ----------
-unordered_set<string> keywords = {
+constexpr string_view keywordList[] = {
     "int", "float", "char", "return", "if", "else", "while", "for", "void", "double", "break", "continue"
 };
 
-unordered_set<string> operators = {
+constexpr string_view operatorList[] = {
     "+", "-", "*", "/", "%", "=", "==", "!=", "<", "<=", ">", ">=", "&&", "||", "!", "&", "|"
 };
+constexpr OperatorTrie operatorTrie = makeOperatorTrie(operatorList);
 
-unordered_set<string> specialSymbols = {
-    "(", ")", "{", "}", ";", ","
-};
+constexpr string_view specialChars = "(){};,";
+
+// ---------- Character classes and keyword hash (LEX_TABLES.h) ----------
+constexpr CharClassTable charClass = makeCharClass(operatorList, specialChars);
+constexpr KeywordTable keywordTable = makeKeywordTable(keywordList);
+
+inline bool hasClass(char c, unsigned char cls) {
+    return charClass.has(c, cls);
+}
+
+bool isKeyword(string_view word) {
+    return keywordTable.find(word) >= 0;
+}
+
+bool isOperatorOrSymbol(const string& token) {
+    if (token.size() == 1 && hasClass(token[0], CC_SPECIAL)) return true;
+    return operatorTrie.isOperator(token);
+}
 
 // ---------- Symbol Table ----------
 struct Symbol {
@@ -32,20 +53,95 @@ struct Symbol {
 vector<Symbol> symbolTable;
 int entryCounter = 1;
 
+// Hand-written matchers, equivalent to the anchored patterns in the comments.
+// Nothing is compiled per call.
+
+// ^[a-zA-Z_][a-zA-Z0-9_]*$
 bool isIdentifier(const string& word) {
-    return regex_match(word, regex("^[a-zA-Z_][a-zA-Z0-9_]*$"));
+    if (word.empty() || !hasClass(word[0], CC_ID_START)) return false;
+    for (char c : word)
+        if (!hasClass(c, CC_ID_CHAR)) return false;
+    return true;
 }
 
+// ^[0-9]+$
 bool isInteger(const string& word) {
-    return regex_match(word, regex("^[0-9]+$"));
+    if (word.empty()) return false;
+    for (char c : word)
+        if (!hasClass(c, CC_DIGIT)) return false;
+    return true;
 }
 
+// ^[0-9]+\.[0-9]+$
 bool isFloat(const string& word) {
-    return regex_match(word, regex("^[0-9]+\\.[0-9]+$"));
+    size_t dot = word.find('.');
+    if (dot == string::npos || dot == 0 || dot + 1 == word.size()) return false;
+    for (size_t i = 0; i < word.size(); ++i)
+        if (i != dot && !hasClass(word[i], CC_DIGIT)) return false;
+    return true;
 }
 
+// ^"[^"]*"$
 bool isLiteral(const string& word) {
-    return regex_match(word, regex("^\"[^\"]*\"$"));
+    return word.size() >= 2 && word.front() == '"' && word.back() == '"' &&
+           word.find('"', 1) == word.size() - 1;
+}
+
+// Characters matched by the last alternative of the token pattern
+constexpr string_view tokenChars = "+-*/%=<>&|!;:,.[]{}()";
+
+constexpr array<bool, 256> makeTokenCharTable() {
+    array<bool, 256> t{};
+    for (char c : tokenChars) t[(unsigned char)c] = true;
+    return t;
+}
+constexpr array<bool, 256> isTokenChar = makeTokenCharTable();
+
+// Finds the next token in line starting the search at pos, with the same
+// result as searching for
+//   "[^"]*" | \d+\.\d+ | \d+ | == | != | <= | >= | && | \|\| | [a-zA-Z_][a-zA-Z0-9_]* | [+\-*/%=<>&|!;:,.\[\]{}()]
+// (alternatives tried in order, unmatched characters skipped). The two-character
+// operators are the multi-character entries of operatorList, found by the trie.
+// Returns false when no token is left; otherwise [start, end) is the token.
+bool nextToken(const string& line, size_t pos, size_t& start, size_t& end) {
+    size_t len = line.size();
+    for (size_t i = pos; i < len; ++i) {
+        char c = line[i];
+        if (c == '"') {
+            size_t close = line.find('"', i + 1);
+            if (close == string::npos) continue;
+            start = i; end = close + 1;
+            return true;
+        }
+        if (hasClass(c, CC_DIGIT)) {
+            size_t j = i;
+            while (j < len && hasClass(line[j], CC_DIGIT)) j++;
+            if (j + 1 < len && line[j] == '.' && hasClass(line[j + 1], CC_DIGIT)) {
+                j += 2;
+                while (j < len && hasClass(line[j], CC_DIGIT)) j++;
+            }
+            start = i; end = j;
+            return true;
+        }
+        if (hasClass(c, CC_OP)) {
+            size_t n = operatorTrie.match(line.data() + i, len - i);
+            if (n >= 2) {
+                start = i; end = i + n;
+                return true;
+            }
+        }
+        if (hasClass(c, CC_ID_START)) {
+            size_t j = i + 1;
+            while (j < len && hasClass(line[j], CC_ID_CHAR)) j++;
+            start = i; end = j;
+            return true;
+        }
+        if (isTokenChar[(unsigned char)c]) {
+            start = i; end = i + 1;
+            return true;
+        }
+    }
+    return false;
 }
 
 int findSymbol(const string& lexeme) {
@@ -86,37 +182,129 @@ string removeComments(const string& input) {
     return output;
 }
 
-void analyzeLine(const string& line, int lineNo) {
-    // 🔧 SAFELY FIXED regex for tokens
-    regex tokenRegex(R"((\"[^\"]*\"|\d+\.\d+|\d+|==|!=|<=|>=|&&|\|\||[a-zA-Z_][a-zA-Z0-9_]*|[+\-*/%=<>&|!;:,.\[\]{}()]))");
-    auto words_begin = sregex_iterator(line.begin(), line.end(), tokenRegex);
-    auto words_end = sregex_iterator();
+enum TokenKind { KEYWORD, IDENTIFIER, INTEGER, FLOAT, LITERAL, OPERATOR, INVALID };
+
+TokenKind classifyToken(const string& token) {
+    if (isKeyword(token)) return KEYWORD;
+    if (isIdentifier(token)) return IDENTIFIER;
+    if (isInteger(token)) return INTEGER;
+    if (isFloat(token)) return FLOAT;
+    if (isLiteral(token)) return LITERAL;
+    if (isOperatorOrSymbol(token)) return OPERATOR;
+    return INVALID;
+}
 
-    for (auto it = words_begin; it != words_end; ++it) {
-        string token = it->str();
+void analyzeLine(const string& line, int lineNo) {
+    size_t pos = 0, start, end;
+    string token;
+    while (nextToken(line, pos, start, end)) {
+        token.assign(line, start, end - start);
+        pos = end;
 
-        if (keywords.count(token)) {
+        switch (classifyToken(token)) {
+        case KEYWORD:
             cout << "[Keyword] " << token << " (Line " << lineNo << ")\n";
-        } else if (isIdentifier(token)) {
+            break;
+        case IDENTIFIER:
             cout << "[Identifier] " << token << " (Line " << lineNo << ")\n";
             addOrUpdateSymbol(token, "Identifier", lineNo);
-        } else if (isInteger(token)) {
+            break;
+        case INTEGER:
             cout << "[Integer] " << token << " (Line " << lineNo << ")\n";
             addOrUpdateSymbol(token, "Integer", lineNo);
-        } else if (isFloat(token)) {
+            break;
+        case FLOAT:
             cout << "[Float] " << token << " (Line " << lineNo << ")\n";
             addOrUpdateSymbol(token, "Float", lineNo);
-        } else if (isLiteral(token)) {
+            break;
+        case LITERAL:
             cout << "[Literal] " << token << " (Line " << lineNo << ")\n";
             addOrUpdateSymbol(token, "Literal", lineNo);
-        } else if (operators.count(token) || specialSymbols.count(token)) {
+            break;
+        case OPERATOR:
             cout << "[Operator/Symbol] " << token << " (Line " << lineNo << ")\n";
-        } else {
+            break;
+        case INVALID:
             cerr << "Lexical Error: Invalid token '" << token << "' on Line " << lineNo << "\n";
+            break;
         }
     }
 }
 
+// ---------- Throughput comparison (--bench) ----------
+// The original std::regex path, kept only as the baseline for --bench.
+TokenKind classifyWithRegex(const string& token) {
+    if (isKeyword(token)) return KEYWORD;
+    if (regex_match(token, regex("^[a-zA-Z_][a-zA-Z0-9_]*$"))) return IDENTIFIER;
+    if (regex_match(token, regex("^[0-9]+$"))) return INTEGER;
+    if (regex_match(token, regex("^[0-9]+\\.[0-9]+$"))) return FLOAT;
+    if (regex_match(token, regex("^\"[^\"]*\"$"))) return LITERAL;
+    if (isOperatorOrSymbol(token)) return OPERATOR;
+    return INVALID;
+}
+
+void tokenizeWithRegex(const string& line, vector<pair<string, TokenKind>>& out) {
+    regex tokenRegex(R"((\"[^\"]*\"|\d+\.\d+|\d+|==|!=|<=|>=|&&|\|\||[a-zA-Z_][a-zA-Z0-9_]*|[+\-*/%=<>&|!;:,.\[\]{}()]))");
+    for (auto it = sregex_iterator(line.begin(), line.end(), tokenRegex); it != sregex_iterator(); ++it)
+        out.push_back({it->str(), classifyWithRegex(it->str())});
+}
+
+void tokenizeWithScanner(const string& line, vector<pair<string, TokenKind>>& out) {
+    size_t pos = 0, start, end;
+    while (nextToken(line, pos, start, end)) {
+        string token = line.substr(start, end - start);
+        TokenKind kind = classifyToken(token);
+        out.push_back({move(token), kind});
+        pos = end;
+    }
+}
+
+// Deterministic C-like source with comments, literals and stray characters
+string generateSource(size_t bytes) {
+    static const char *pieces[] = {
+        "int ", "float ", "return ", "while ", "if ", "else ", "count", "value", "total_sum",
+        "ptr", "i", "j", " = ", " == ", " + ", " <= ", " && ", " || ", "!", "(", ")", "{", "}",
+        ";", ",", "42", "3.14", "1000", "7.", "\"hello world\"", "\"x\"", "[", "]", " ", " ",
+        "/* block comment */", "// line comment\n", "$", "\n", "\n", "\n"};
+    const size_t n = sizeof(pieces) / sizeof(pieces[0]);
+    string text;
+    uint32_t seed = 2024;
+    while (text.size() < bytes) {
+        seed = seed * 1103515245u + 12345u;
+        text += pieces[(seed >> 16) % n];
+    }
+    return text;
+}
+
+template <class Tokenize>
+double megabytesPerSecond(Tokenize tokenize, const string& code, vector<pair<string, TokenKind>>& out) {
+    istringstream iss(code);
+    string line;
+    auto t0 = chrono::steady_clock::now();
+    while (getline(iss, line)) tokenize(line, out);
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    return code.size() / 1e6 / secs;
+}
+
+int runBenchmark(size_t bytes) {
+    string code = removeComments(generateSource(bytes));
+    vector<pair<string, TokenKind>> before, after;
+    double mbBefore = megabytesPerSecond(tokenizeWithRegex, code, before);
+    double mbAfter = megabytesPerSecond(tokenizeWithScanner, code, after);
+
+    cout << fixed << setprecision(2);
+    cout << "Generated source: " << code.size() / 1e6 << " MB after comment removal, "
+         << after.size() << " tokens\n";
+    cout << "std::regex per call:  " << mbBefore << " MB/s\n";
+    cout << "precompiled scanner:  " << mbAfter << " MB/s\n";
+    cout << "Speedup: " << setprecision(1) << mbAfter / mbBefore << "x\n";
+    if (before != after) {
+        cout << "Mismatch between the two token streams\n";
+        return 1;
+    }
+    return 0;
+}
+
 void printSymbolTable() {
     cout << "\n========= SYMBOL TABLE =========\n";
     cout << left << setw(8) << "Entry"
@@ -135,7 +323,12 @@ void printSymbolTable() {
     }
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        size_t megabytes = argc > 2 ? atoi(argv[2]) : 1;
+        return runBenchmark(megabytes << 20);
+    }
+
     string filename;
     cout << "Enter source file name: ";
     cin >> filename;
@@ -3,10 +3,6 @@
 #include <string.h>
 #include <ctype.h>
 
-#define MAX_LEXEME_LENGTH 100
-#define MAX_SYMBOL_TABLE_ENTRIES 1000
-#define MAX_TOKENS 1000
-
 // Token types
 #define KEYWORD "keyword"
 #define IDENTIFIER "identifier"
@@ -16,38 +12,210 @@
 #define SPECIAL "special"
 #define LITERAL "literal"
 
+// Lexemes live in an arena of chained blocks and are interned, so every
+// distinct lexeme is stored once and tokens/symbols just point at it.
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t used, capacity;
+    char data[];
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock *head;
+} Arena;
+
 // Symbol table entry structure
 typedef struct {
-    int entry_no;
-    char lexeme[MAX_LEXEME_LENGTH];
-    char token_type[20];
-    int line_declared;
-    int line_used;
+    const char *lexeme;      // interned
+    const char *token_type;
+    int line_declared;       // first occurrence
+    int line_used;           // last occurrence
 } SymbolEntry;
 
 // Token structure
 typedef struct {
-    char token_type[20];
-    char lexeme[MAX_LEXEME_LENGTH];
+    const char *token_type;
+    const char *lexeme;      // interned
     int line;
 } Token;
 
+// Interned strings: open addressing, the slot count is a power of two
+typedef struct {
+    const char **slots;
+    size_t count, capacity;
+} InternTable;
+
+// Symbols: entries in first-occurrence order plus an open-addressing index
+// holding entry index + 1 (0 = empty)
+typedef struct {
+    SymbolEntry *entries;
+    size_t count, capacity;
+    size_t *index;
+    size_t index_capacity;
+} SymbolTable;
+
+typedef struct {
+    Token *items;
+    size_t count, capacity;
+} TokenList;
+
 // Function prototypes
 int is_keyword(const char *lexeme);
 int is_one_char_op(char c);
 int is_two_char_op(const char *s);
 int is_special_symbol(char c);
 
-int main() {
-    const char *keywords[] = {
-        "auto", "break", "case", "char", "const", "continue", "default", "do", "double", "else", "enum",
-        "extern", "float", "for", "goto", "if", "int", "long", "register", "return", "short", "signed",
-        "sizeof", "static", "struct", "switch", "typedef", "union", "unsigned", "void", "volatile", "while"
-    };
-    const char *one_char_ops = "+-*%=<>!&|";
-    const char *two_char_ops[] = {"++", "--", "==", "!=", "<=", ">=", "&&", "||", "+=", "-=", "*=", "/="};
-    const char *special_symbols = "(){};,";
+void *xmalloc(size_t n) {
+    void *p = malloc(n);
+    if (p == NULL) {
+        perror("Memory allocation failed");
+        exit(1);
+    }
+    return p;
+}
+
+void *xcalloc(size_t n, size_t size) {
+    void *p = calloc(n, size);
+    if (p == NULL) {
+        perror("Memory allocation failed");
+        exit(1);
+    }
+    return p;
+}
+
+void *xrealloc(void *p, size_t n) {
+    p = realloc(p, n);
+    if (p == NULL) {
+        perror("Memory allocation failed");
+        exit(1);
+    }
+    return p;
+}
+
+// Copy len bytes into the arena as a NUL-terminated string
+const char *arena_strndup(Arena *arena, const char *s, size_t len) {
+    ArenaBlock *block = arena->head;
+    if (block == NULL || block->used + len + 1 > block->capacity) {
+        size_t capacity = len + 1 > ARENA_BLOCK_SIZE ? len + 1 : ARENA_BLOCK_SIZE;
+        block = xmalloc(sizeof(ArenaBlock) + capacity);
+        block->next = arena->head;
+        block->used = 0;
+        block->capacity = capacity;
+        arena->head = block;
+    }
+    char *dst = block->data + block->used;
+    memcpy(dst, s, len);
+    dst[len] = '\0';
+    block->used += len + 1;
+    return dst;
+}
+
+void arena_free(Arena *arena) {
+    while (arena->head) {
+        ArenaBlock *next = arena->head->next;
+        free(arena->head);
+        arena->head = next;
+    }
+}
 
+// FNV-1a
+size_t hash_bytes(const char *s, size_t len) {
+    size_t h = 14695981039346656037ULL;
+    for (size_t k = 0; k < len; k++) {
+        h ^= (unsigned char)s[k];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Return the interned copy of s[0..len), adding it if needed
+const char *intern(InternTable *table, Arena *arena, const char *s, size_t len) {
+    if (table->count * 2 >= table->capacity) {
+        // keep the load factor under 1/2
+        size_t capacity = table->capacity ? table->capacity * 2 : 1024;
+        const char **slots = xcalloc(capacity, sizeof(const char *));
+        for (size_t k = 0; k < table->capacity; k++) {
+            const char *old = table->slots[k];
+            if (old == NULL) continue;
+            size_t slot = hash_bytes(old, strlen(old)) & (capacity - 1);
+            while (slots[slot]) slot = (slot + 1) & (capacity - 1);
+            slots[slot] = old;
+        }
+        free(table->slots);
+        table->slots = slots;
+        table->capacity = capacity;
+    }
+
+    size_t mask = table->capacity - 1;
+    size_t slot = hash_bytes(s, len) & mask;
+    while (table->slots[slot]) {
+        const char *cand = table->slots[slot];
+        if (strncmp(cand, s, len) == 0 && cand[len] == '\0') return cand;
+        slot = (slot + 1) & mask;
+    }
+    table->slots[slot] = arena_strndup(arena, s, len);
+    table->count++;
+    return table->slots[slot];
+}
+
+// Interned lexemes are unique, so a symbol is keyed by the lexeme pointer and its type
+size_t symbol_hash(const char *lexeme, const char *token_type) {
+    size_t h = (size_t)lexeme * 0x9E3779B97F4A7C15ULL;
+    h ^= hash_bytes(token_type, strlen(token_type));
+    return h ^ (h >> 29);
+}
+
+void add_symbol(SymbolTable *table, const char *lexeme, const char *token_type, int line) {
+    if (table->count * 2 >= table->index_capacity) {
+        size_t capacity = table->index_capacity ? table->index_capacity * 2 : 1024;
+        size_t *index = xcalloc(capacity, sizeof(size_t));
+        for (size_t e = 0; e < table->count; e++) {
+            size_t slot = symbol_hash(table->entries[e].lexeme, table->entries[e].token_type) & (capacity - 1);
+            while (index[slot]) slot = (slot + 1) & (capacity - 1);
+            index[slot] = e + 1;
+        }
+        free(table->index);
+        table->index = index;
+        table->index_capacity = capacity;
+    }
+
+    size_t mask = table->index_capacity - 1;
+    size_t slot = symbol_hash(lexeme, token_type) & mask;
+    while (table->index[slot]) {
+        SymbolEntry *e = &table->entries[table->index[slot] - 1];
+        if (e->lexeme == lexeme && strcmp(e->token_type, token_type) == 0) {
+            e->line_used = line;
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (table->count == table->capacity) {
+        table->capacity = table->capacity ? table->capacity * 2 : 256;
+        table->entries = xrealloc(table->entries, table->capacity * sizeof(SymbolEntry));
+    }
+    SymbolEntry *e = &table->entries[table->count++];
+    e->lexeme = lexeme;
+    e->token_type = token_type;
+    e->line_declared = line;
+    e->line_used = line;
+    table->index[slot] = table->count;
+}
+
+void add_token(TokenList *list, const char *token_type, const char *lexeme, int line) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 1024;
+        list->items = xrealloc(list->items, list->capacity * sizeof(Token));
+    }
+    list->items[list->count].token_type = token_type;
+    list->items[list->count].lexeme = lexeme;
+    list->items[list->count].line = line;
+    list->count++;
+}
+
+int main() {
     FILE *fp = fopen("test.c", "r");
     if (fp == NULL) {
         perror("Error opening file");
@@ -68,16 +236,16 @@ int main() {
     }
 
     // Read file content
-    fread(buffer, 1, fsize, fp);
+    fsize = fread(buffer, 1, fsize, fp);
     buffer[fsize] = '\0';
     fclose(fp);
 
-    SymbolEntry symbol_table[MAX_SYMBOL_TABLE_ENTRIES];
-    Token tokens[MAX_TOKENS];
-    int symbol_table_size = 0;
-    int token_count = 0;
+    Arena arena = {0};
+    InternTable lexemes = {0};
+    SymbolTable symbol_table = {0};
+    TokenList tokens = {0};
     int line_number = 1;
-    int i = 0;
+    long i = 0;
 
     while (i < fsize) {
         char c = buffer[i];
@@ -130,120 +298,55 @@ int main() {
 
         // Handle identifiers and keywords
         if (isalpha(c) || c == '_') {
-            char lexeme[MAX_LEXEME_LENGTH] = {0};
-            int j = 0;
-
-            lexeme[j++] = c;
+            long start = i;
             i++;
             while (i < fsize && (isalnum(buffer[i]) || buffer[i] == '_')) {
-                if (j < MAX_LEXEME_LENGTH - 1) {
-                    lexeme[j++] = buffer[i];
-                }
                 i++;
             }
-            lexeme[j] = '\0';
+            const char *lexeme = intern(&lexemes, &arena, buffer + start, i - start);
 
             if (is_keyword(lexeme)) {
-                tokens[token_count].line = line_number;
-                strcpy(tokens[token_count].token_type, KEYWORD);
-                strcpy(tokens[token_count].lexeme, lexeme);
-                token_count++;
+                add_token(&tokens, KEYWORD, lexeme, line_number);
             } else {
-                tokens[token_count].line = line_number;
-                strcpy(tokens[token_count].token_type, IDENTIFIER);
-                strcpy(tokens[token_count].lexeme, lexeme);
-                token_count++;
-
-                symbol_table[symbol_table_size].entry_no = symbol_table_size + 1;
-                strcpy(symbol_table[symbol_table_size].lexeme, lexeme);
-                strcpy(symbol_table[symbol_table_size].token_type, IDENTIFIER);
-                symbol_table[symbol_table_size].line_declared = line_number;
-                symbol_table[symbol_table_size].line_used = line_number;
-                symbol_table_size++;
+                add_token(&tokens, IDENTIFIER, lexeme, line_number);
+                add_symbol(&symbol_table, lexeme, IDENTIFIER, line_number);
             }
             continue;
         }
 
         // Handle numbers and floats
         if (isdigit(c) || (c == '.' && i + 1 < fsize && isdigit(buffer[i + 1]))) {
-            char lexeme[MAX_LEXEME_LENGTH] = {0};
-            int j = 0;
-            int is_float = 0;
-
-            lexeme[j++] = c;
+            long start = i;
+            int is_float = (c == '.');
             i++;
-            if (c == '.') {
-                is_float = 1;
-            }
 
-            while (i < fsize && j < MAX_LEXEME_LENGTH - 1) {
+            while (i < fsize) {
                 if (isdigit(buffer[i])) {
-                    lexeme[j++] = buffer[i];
                     i++;
                 } else if (buffer[i] == '.' && !is_float) {
-                    lexeme[j++] = buffer[i];
                     i++;
                     is_float = 1;
                 } else {
                     break;
                 }
             }
-            lexeme[j] = '\0';
-
-            // Validate number format
-            if (is_float) {
-                if (lexeme[j - 1] == '.') {
-                    lexeme[j - 1] = '\0';
-                    i--;
-                    if (strlen(lexeme) == 0) {
-                        fprintf(stderr, "Lexical error at line %d: invalid number '%s'\n", line_number, lexeme);
-                        continue;
-                    } else {
-                        tokens[token_count].line = line_number;
-                        strcpy(tokens[token_count].token_type, INTEGER);
-                        strcpy(tokens[token_count].lexeme, lexeme);
-                        token_count++;
-
-                        symbol_table[symbol_table_size].entry_no = symbol_table_size + 1;
-                        strcpy(symbol_table[symbol_table_size].lexeme, lexeme);
-                        strcpy(symbol_table[symbol_table_size].token_type, INTEGER);
-                        symbol_table[symbol_table_size].line_declared = line_number;
-                        symbol_table[symbol_table_size].line_used = line_number;
-                        symbol_table_size++;
-                    }
-                } else {
-                    tokens[token_count].line = line_number;
-                    strcpy(tokens[token_count].token_type, FLOAT);
-                    strcpy(tokens[token_count].lexeme, lexeme);
-                    token_count++;
-
-                    symbol_table[symbol_table_size].entry_no = symbol_table_size + 1;
-                    strcpy(symbol_table[symbol_table_size].lexeme, lexeme);
-                    strcpy(symbol_table[symbol_table_size].token_type, FLOAT);
-                    symbol_table[symbol_table_size].line_declared = line_number;
-                    symbol_table[symbol_table_size].line_used = line_number;
-                    symbol_table_size++;
-                }
-            } else {
-                tokens[token_count].line = line_number;
-                strcpy(tokens[token_count].token_type, INTEGER);
-                strcpy(tokens[token_count].lexeme, lexeme);
-                token_count++;
-
-                symbol_table[symbol_table_size].entry_no = symbol_table_size + 1;
-                strcpy(symbol_table[symbol_table_size].lexeme, lexeme);
-                strcpy(symbol_table[symbol_table_size].token_type, INTEGER);
-                symbol_table[symbol_table_size].line_declared = line_number;
-                symbol_table[symbol_table_size].line_used = line_number;
-                symbol_table_size++;
+
+            // A trailing '.' is not part of the number
+            if (is_float && buffer[i - 1] == '.') {
+                i--;
+                is_float = 0;
             }
+            const char *type = is_float ? FLOAT : INTEGER;
+            const char *lexeme = intern(&lexemes, &arena, buffer + start, i - start);
+            add_token(&tokens, type, lexeme, line_number);
+            add_symbol(&symbol_table, lexeme, type, line_number);
             continue;
         }
 
         // Handle literals (strings)
         if (c == '"') {
             i++;
-            int start = i;
+            long start = i;
             int error = 0;
             while (i < fsize) {
                 if (buffer[i] == '"') {
@@ -276,61 +379,32 @@ int main() {
                 continue;
             }
 
-            int len = i - start;
-            char lexeme[MAX_LEXEME_LENGTH];
-            if (len >= MAX_LEXEME_LENGTH) {
-                strncpy(lexeme, buffer + start, MAX_LEXEME_LENGTH - 1);
-                lexeme[MAX_LEXEME_LENGTH - 1] = '\0';
-            } else {
-                strncpy(lexeme, buffer + start, len);
-                lexeme[len] = '\0';
-            }
+            const char *lexeme = intern(&lexemes, &arena, buffer + start, i - start);
             i++;
 
-            tokens[token_count].line = line_number;
-            strcpy(tokens[token_count].token_type, LITERAL);
-            strcpy(tokens[token_count].lexeme, lexeme);
-            token_count++;
-
-            symbol_table[symbol_table_size].entry_no = symbol_table_size + 1;
-            strcpy(symbol_table[symbol_table_size].lexeme, lexeme);
-            strcpy(symbol_table[symbol_table_size].token_type, LITERAL);
-            symbol_table[symbol_table_size].line_declared = line_number;
-            symbol_table[symbol_table_size].line_used = line_number;
-            symbol_table_size++;
+            add_token(&tokens, LITERAL, lexeme, line_number);
+            add_symbol(&symbol_table, lexeme, LITERAL, line_number);
             continue;
         }
 
         // Handle operators
         if (is_one_char_op(c)) {
-            char op[3] = {c, '\0'};
             if (i + 1 < fsize) {
                 char two_char[3] = {c, buffer[i + 1], '\0'};
                 if (is_two_char_op(two_char)) {
-                    strcpy(op, two_char);
-                    tokens[token_count].line = line_number;
-                    strcpy(tokens[token_count].token_type, OPERATOR);
-                    strcpy(tokens[token_count].lexeme, op);
-                    token_count++;
+                    add_token(&tokens, OPERATOR, intern(&lexemes, &arena, two_char, 2), line_number);
                     i += 2;
                     continue;
                 }
             }
-            tokens[token_count].line = line_number;
-            strcpy(tokens[token_count].token_type, OPERATOR);
-            strcpy(tokens[token_count].lexeme, op);
-            token_count++;
+            add_token(&tokens, OPERATOR, intern(&lexemes, &arena, buffer + i, 1), line_number);
             i++;
             continue;
         }
 
         // Handle special symbols
         if (is_special_symbol(c)) {
-            char sym[2] = {c, '\0'};
-            tokens[token_count].line = line_number;
-            strcpy(tokens[token_count].token_type, SPECIAL);
-            strcpy(tokens[token_count].lexeme, sym);
-            token_count++;
+            add_token(&tokens, SPECIAL, intern(&lexemes, &arena, buffer + i, 1), line_number);
             i++;
             continue;
         }
@@ -343,22 +417,27 @@ int main() {
     // Print tokens
     printf("Tokens:\n");
     printf("%-10s %-20s %-15s\n", "Line", "Token Type", "Lexeme");
-    for (int idx = 0; idx < token_count; idx++) {
-        printf("%-10d %-20s %-15s\n", tokens[idx].line, tokens[idx].token_type, tokens[idx].lexeme);
+    for (size_t idx = 0; idx < tokens.count; idx++) {
+        printf("%-10d %-20s %-15s\n", tokens.items[idx].line, tokens.items[idx].token_type, tokens.items[idx].lexeme);
     }
 
     // Print symbol table
     printf("\nSymbol Table:\n");
     printf("%-10s %-20s %-15s %-15s %-15s\n", "Entry", "Lexeme", "Token Type", "Line Decl", "Line Used");
-    for (int idx = 0; idx < symbol_table_size; idx++) {
-        printf("%-10d %-20s %-15s %-15d %-15d\n", 
-               symbol_table[idx].entry_no, 
-               symbol_table[idx].lexeme, 
-               symbol_table[idx].token_type, 
-               symbol_table[idx].line_declared, 
-               symbol_table[idx].line_used);
+    for (size_t idx = 0; idx < symbol_table.count; idx++) {
+        printf("%-10zu %-20s %-15s %-15d %-15d\n",
+               idx + 1,
+               symbol_table.entries[idx].lexeme,
+               symbol_table.entries[idx].token_type,
+               symbol_table.entries[idx].line_declared,
+               symbol_table.entries[idx].line_used);
     }
 
+    free(tokens.items);
+    free(symbol_table.entries);
+    free(symbol_table.index);
+    free(lexemes.slots);
+    arena_free(&arena);
     free(buffer);
     return 0;
 }
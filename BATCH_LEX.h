@@ -0,0 +1,105 @@
+// Batch driver shared by lab1.cpp and LEXICAL_TABLE.cpp (--batch): finds the
+// files to lex and runs each lexer's per-file job on a work-stealing pool.
+//
+//   vector<string> paths = batchFiles(source);   // directory or list of paths
+//   runBatch(paths, nThreads, [&](size_t k, int worker) { lexOne(paths[k], results[k], worker); });
+//
+// Every worker owns a deque of files. It takes work from the back of its own
+// deque and, once that is empty, steals from the front of someone else's.
+// Files are dealt biggest first, so steals pick up the largest work left.
+// Jobs run in any order; callers merge their results in file order.
+#ifndef BATCH_LEX_H
+#define BATCH_LEX_H
+
+#include <algorithm>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+
+// A directory (searched recursively for C/C++ sources) or a file with one path per line
+inline std::vector<std::string> batchFiles(const std::string &source) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
+    std::error_code ec;
+    if (fs::is_directory(source, ec)) {
+        static const std::set<std::string> extensions = {".c", ".h", ".cc", ".cpp", ".hpp"};
+        for (auto it = fs::recursive_directory_iterator(source, fs::directory_options::skip_permission_denied, ec);
+             it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            if (ec) break;
+            if (it->is_regular_file(ec) && extensions.count(it->path().extension().string()))
+                files.push_back(it->path().string());
+        }
+        std::sort(files.begin(), files.end());
+    } else {
+        std::ifstream list(source);
+        std::string path;
+        while (std::getline(list, path))
+            if (!path.empty()) files.push_back(path);
+    }
+    return files;
+}
+
+struct WorkQueue {
+    std::mutex lock;
+    std::deque<size_t> tasks;
+};
+
+// Runs task(i, worker) for i in order[0..n) on nThreads threads
+template <class Task>
+void runWorkStealing(const std::vector<size_t> &order, int nThreads, Task &&task) {
+    std::vector<WorkQueue> queues(nThreads);
+    for (size_t k = 0; k < order.size(); k++) queues[k % nThreads].tasks.push_back(order[k]);
+
+    auto worker = [&](int self) {
+        while (true) {
+            size_t job;
+            bool found = false;
+            {
+                std::lock_guard<std::mutex> guard(queues[self].lock);
+                if (!queues[self].tasks.empty()) {
+                    job = queues[self].tasks.back();
+                    queues[self].tasks.pop_back();
+                    found = true;
+                }
+            }
+            for (int k = 1; !found && k < nThreads; k++) {
+                WorkQueue &victim = queues[(self + k) % nThreads];
+                std::lock_guard<std::mutex> guard(victim.lock);
+                if (!victim.tasks.empty()) {
+                    job = victim.tasks.front();
+                    victim.tasks.pop_front();
+                    found = true;
+                }
+            }
+            // nothing is ever added, so empty queues everywhere means done
+            if (!found) return;
+            task(job, self);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int w = 0; w < nThreads; w++) workers.emplace_back(worker, w);
+    for (auto &w : workers) w.join();
+}
+
+// Runs job(k, worker) for every file paths[k] on nThreads threads, biggest file first
+template <class Job>
+void runBatch(const std::vector<std::string> &paths, int nThreads, Job &&job) {
+    std::vector<size_t> order(paths.size());
+    std::vector<off_t> sizes(paths.size(), 0);
+    for (size_t k = 0; k < paths.size(); k++) {
+        order[k] = k;
+        struct stat st;
+        if (stat(paths[k].c_str(), &st) == 0) sizes[k] = st.st_size;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+    runWorkStealing(order, nThreads, job);
+}
+
+#endif
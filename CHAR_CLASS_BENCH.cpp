@@ -0,0 +1,160 @@
+#include <bits/stdc++.h>
+#include "LEX_TABLES.h"
+using namespace std;
+
+// Microbenchmark for the lexer's classification path: the old
+// unordered_set<char>/unordered_set<string> lookups against the constexpr
+// character-class table and keyword perfect hash used by LEXICAL_TABLE.cpp.
+// Both scanners follow LEXICAL_TABLE.cpp's lexLine() but only count tokens,
+// so the difference is the cost of classifying characters and words.
+//
+// usage: CHAR_CLASS_BENCH [file]   (without a file, 16 MB of C-like text is generated)
+
+// ---------- Before: hash sets ----------
+unordered_set<string> keywords = {"int", "float", "double", "long", "return", "void", "if", "else", "while", "for"};
+unordered_set<char> singleOp = {'=', '+', '-', '*', '/', '<', '>', '!', '%'};
+unordered_set<string> multiOp = {"==","!=","<=",">=","++","--","+=","-=","*=","/="};
+unordered_set<char> special = {')','(','{','}',';',','};
+
+// ---------- After: compile-time tables (same as LEXICAL_TABLE.cpp) ----------
+constexpr string_view keywordList[] = {"int", "float", "double", "long", "return", "void", "if", "else", "while", "for"};
+constexpr string_view singleOpChars = "=+-*/<>!%";
+constexpr string_view specialChars = ")({};,";
+unordered_set<string_view> multiOpViews = {"==","!=","<=",">=","++","--","+=","-=","*=","/="};
+
+constexpr CharClassTable charClass = makeCharClass(singleOpChars, specialChars);
+constexpr KeywordTable keywordTable = makeKeywordTable(keywordList);
+
+inline bool hasClass(char c, unsigned char cls) {
+    return charClass.has(c, cls);
+}
+
+bool isKeyword(string_view s) {
+    return keywordTable.find(s) >= 0;
+}
+
+struct Counts {
+    long tokens = 0, keywords = 0;
+};
+
+// Old path: builds std::strings and probes hash sets, like the original lexers
+Counts scanBefore(const string &text) {
+    Counts n;
+    size_t i = 0, len = text.size();
+    while (i < len) {
+        char c = text[i];
+        if (isspace((unsigned char)c)) { i++; continue; }
+        if (isalpha((unsigned char)c) || c == '_') {
+            string token = "";
+            while (i < len && (isalnum((unsigned char)text[i]) || text[i] == '_')) token += text[i++];
+            n.tokens++;
+            if (keywords.find(token) != keywords.end()) n.keywords++;
+            continue;
+        }
+        if (isdigit((unsigned char)c)) {
+            while (i < len && (isdigit((unsigned char)text[i]) || text[i] == '.')) i++;
+            n.tokens++;
+            continue;
+        }
+        if (i + 1 < len && multiOp.find(string(1, c) + text[i + 1]) != multiOp.end()) {
+            n.tokens++;
+            i += 2;
+            continue;
+        }
+        if (singleOp.find(c) != singleOp.end() || special.find(c) != special.end()) n.tokens++;
+        i++;
+    }
+    return n;
+}
+
+// New path: one table load per character, perfect hash per word
+Counts scanAfter(const string &text) {
+    Counts n;
+    size_t i = 0, len = text.size();
+    while (i < len) {
+        char c = text[i];
+        if (hasClass(c, CC_SPACE)) { i++; continue; }
+        if (hasClass(c, CC_ID_START)) {
+            size_t start = i;
+            while (i < len && hasClass(text[i], CC_ID_CHAR)) i++;
+            n.tokens++;
+            if (isKeyword(string_view(text).substr(start, i - start))) n.keywords++;
+            continue;
+        }
+        if (hasClass(c, CC_DIGIT)) {
+            while (i < len && (hasClass(text[i], CC_DIGIT) || text[i] == '.')) i++;
+            n.tokens++;
+            continue;
+        }
+        if (i + 1 < len && multiOpViews.count(string_view(text).substr(i, 2))) {
+            n.tokens++;
+            i += 2;
+            continue;
+        }
+        if (hasClass(c, CC_OP | CC_SPECIAL)) n.tokens++;
+        i++;
+    }
+    return n;
+}
+
+string generate(size_t bytes) {
+    static const char *words[] = {"int", "float", "return", "while", "for", "if", "else",
+                                  "count", "value", "buffer_size", "i", "j", "total", "node_next",
+                                  "3.14", "42", "0", "1000", "=", "==", "+", "+=", "<", "<=", "++",
+                                  "*", "/", "!", "!=", "(", ")", "{", "}", ";", ","};
+    const size_t nWords = sizeof(words) / sizeof(words[0]);
+    string text;
+    text.reserve(bytes + 64);
+    uint32_t seed = 12345;
+    while (text.size() < bytes) {
+        seed = seed * 1103515245u + 12345u;
+        text += words[(seed >> 16) % nWords];
+        text += ((seed >> 8) % 8 == 0) ? '\n' : ' ';
+    }
+    return text;
+}
+
+template <class Scan>
+double tokensPerSecond(Scan scan, const string &text, Counts &out) {
+    double best = 0;
+    for (int rep = 0; rep < 5; rep++) {
+        auto t0 = chrono::steady_clock::now();
+        out = scan(text);
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        best = max(best, out.tokens / secs);
+    }
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    string text;
+    if (argc > 1) {
+        ifstream file(argv[1], ios::binary);
+        if (!file.is_open()) {
+            cout << "Error opening file\n";
+            return 1;
+        }
+        stringstream buffer;
+        buffer << file.rdbuf();
+        text = buffer.str();
+    } else {
+        text = generate(16 << 20);
+    }
+
+    Counts before, after;
+    double tpsBefore = tokensPerSecond(scanBefore, text, before);
+    double tpsAfter = tokensPerSecond(scanAfter, text, after);
+
+    cout << fixed << setprecision(1);
+    cout << "Input: " << text.size() / 1e6 << " MB, " << before.tokens << " tokens, "
+         << before.keywords << " keywords\n";
+    cout << "Before (hash sets):     " << tpsBefore / 1e6 << " M tokens/s\n";
+    cout << "After  (constexpr):     " << tpsAfter / 1e6 << " M tokens/s\n";
+    cout << "Speedup: " << setprecision(2) << tpsAfter / tpsBefore << "x\n";
+    if (before.tokens != after.tokens || before.keywords != after.keywords) {
+        cout << "Mismatch: after counted " << after.tokens << " tokens, "
+             << after.keywords << " keywords\n";
+        return 1;
+    }
+    return 0;
+}
@@ -3,14 +3,22 @@
 #include <string>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <stack>
 #include <iomanip>
 #include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <array>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <string_view>
+#include "DFA_MINIMIZE.h"
+#include "FOLLOWPOS.h"
 using namespace std;
 
-// Node types
-enum Type { LEAF, OR, CAT, STAR };
-
 // Syntax tree node
 struct Node {
     Type type;
@@ -18,7 +26,7 @@ struct Node {
     char symbol;
     int position; // Only valid for LEAF nodes
     bool nullable;
-    set<int> firstpos, lastpos;
+    PosSet firstpos, lastpos;
 
     Node(Type t, char sym = 0) : type(t), left(nullptr), right(nullptr), child(nullptr), symbol(sym), position(-1), nullable(false) {}
 };
@@ -100,155 +108,82 @@ Node *buildSyntaxTree(const string &postfix, vector<Node *> &leaves) {
     return S.top();
 }
 
-// Computes nullable, firstpos, lastpos recursively for all nodes
-void compute_nullable_first_last(Node *n) {
-    if (!n) return;
-    if (n->type == LEAF) {
-        n->nullable = false;
-        n->firstpos.insert(n->position);
-        n->lastpos.insert(n->position);
-    } else if (n->type == OR) {
-        compute_nullable_first_last(n->left);
-        compute_nullable_first_last(n->right);
-        n->nullable = n->left->nullable || n->right->nullable;
-        n->firstpos.insert(n->left->firstpos.begin(), n->left->firstpos.end());
-        n->firstpos.insert(n->right->firstpos.begin(), n->right->firstpos.end());
-        n->lastpos.insert(n->left->lastpos.begin(), n->left->lastpos.end());
-        n->lastpos.insert(n->right->lastpos.begin(), n->right->lastpos.end());
-    } else if (n->type == CAT) {
-        compute_nullable_first_last(n->left);
-        compute_nullable_first_last(n->right);
-        n->nullable = n->left->nullable && n->right->nullable;
-        n->firstpos = n->left->firstpos;
-        if (n->left->nullable)
-            n->firstpos.insert(n->right->firstpos.begin(), n->right->firstpos.end());
-        n->lastpos = n->right->lastpos;
-        if (n->right->nullable)
-            n->lastpos.insert(n->left->lastpos.begin(), n->left->lastpos.end());
-    } else if (n->type == STAR) {
-        compute_nullable_first_last(n->child);
-        n->nullable = true;
-        n->firstpos = n->child->firstpos;
-        n->lastpos = n->child->lastpos;
-    }
-}
+// Dstates is a set of sets of positions, looked up by hash
+typedef PosSet State;
 
-// Computes followpos for all positions, fills followpos_map
-void compute_followpos(Node *n, map<int, set<int>> &followpos) {
-    if (!n) return;
-    if (n->type == CAT) {
-        for (int i : n->left->lastpos)
-            followpos[i].insert(n->right->firstpos.begin(), n->right->firstpos.end());
-    } else if (n->type == STAR) {
-        for (int i : n->child->lastpos)
-            followpos[i].insert(n->child->firstpos.begin(), n->child->firstpos.end());
-    }
-    if (n->type == OR || n->type == CAT) {
-        compute_followpos(n->left, followpos);
-        compute_followpos(n->right, followpos);
-    } else if (n->type == STAR) {
-        compute_followpos(n->child, followpos);
-    }
+// Symbol of every position (index 0 unused), so a lookup is one load
+vector<char> position_symbols(const vector<Node *> &leaves) {
+    vector<char> symbol(leaves.size() + 1, 0);
+    for (auto *leaf : leaves) symbol[leaf->position] = leaf->symbol;
+    return symbol;
 }
 
-// Dstates is a set of sets of positions
-typedef set<int> State;
-struct StateCmp {
-    bool operator()(const State &a, const State &b) const { return a < b; }
-};
-
-// Returns the symbol at a given position
-char symbol_at(int pos, const vector<Node *> &leaves) {
-    for (auto *leaf : leaves)
-        if (leaf->position == pos)
-            return leaf->symbol;
-    return 0;
+// States in the order a map<set<int>, int> would hold them: by their
+// position lists, compared lexicographically
+vector<int> states_in_set_order(const vector<State> &states) {
+    vector<vector<int>> lists;
+    for (auto &T : states) lists.push_back(T.positions());
+    vector<int> order(states.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = int(i);
+    sort(order.begin(), order.end(), [&](int a, int b) { return lists[a] < lists[b]; });
+    return order;
 }
 
-// Constructs DFA from followpos. Returns transition table and state set.
-void construct_dfa(Node *root, const vector<Node *> &leaves, const map<int, set<int>> &followpos,
-                   map<State, int, StateCmp> &dfa_states, vector<map<char, int>> &dfa_trans,
+// Constructs DFA from followpos. Returns transition table and state set
+// (dfa_states[id] is the set of positions of state id).
+void construct_dfa(Node *root, const vector<Node *> &leaves, const vector<PosSet> &followpos,
+                   vector<State> &dfa_states, vector<map<char, int>> &dfa_trans,
                    int &accept_state) {
     vector<State> states;
-    map<State, int, StateCmp> state_ids;
-    vector<bool> is_marked;
+    unordered_map<State, int, PosSetHash> state_ids;
+    vector<char> symbol = position_symbols(leaves);
 
     State start = root->firstpos;
     states.push_back(start);
     state_ids[start] = 0;
-    is_marked.push_back(false);
+    dfa_trans.assign(1, map<char, int>());
 
     int marker_pos = -1;
     for (size_t i = 0; i < leaves.size(); ++i)
         if (leaves[i]->symbol == '#')
             marker_pos = leaves[i]->position;
 
-    while (true) {
-        int i = -1;
-        for (size_t j = 0; j < states.size(); ++j)
-            if (!is_marked[j]) {
-                i = int(j);
-                break;
-            }
-        if (i == -1) break;
-        is_marked[i] = true;
-        State T = states[i];
-        map<char, State> move_map;
-        for (int p : T) {
-            char a = symbol_at(p, leaves);
-            if (a == '#') continue;
-            move_map[a].insert(p);
-        }
-        for (auto pr : move_map) {
-            char a = pr.first;
-            State U;
-            for (int p : pr.second)
-                U.insert(followpos.at(p).begin(), followpos.at(p).end());
-            if (!state_ids.count(U)) {
-                state_ids[U] = int(states.size());
-                states.push_back(U);
-                is_marked.push_back(false);
+    // Worklist: states[next..] are unmarked. Each state is expanded once, and
+    // its transitions are filled in as its successors are found.
+    for (size_t next = 0; next < states.size(); ++next) {
+        map<char, State> move_map;  // symbol -> union of followpos
+        states[next].for_each([&](int p) {
+            char a = symbol[p];
+            if (a != '#') move_map[a].insert(followpos[p]);
+        });
+        for (auto &pr : move_map) {
+            auto found = state_ids.emplace(move(pr.second), int(states.size()));
+            if (found.second) {
+                states.push_back(found.first->first);
+                dfa_trans.emplace_back();
             }
-        }
-    }
-    dfa_states = state_ids;
-    dfa_trans = vector<map<char, int>>(states.size());
-    for (size_t i = 0; i < states.size(); ++i) {
-        State T = states[i];
-        map<char, State> move_map;
-        for (int p : T) {
-            char a = symbol_at(p, leaves);
-            if (a == '#') continue;
-            move_map[a].insert(p);
-        }
-        for (auto pr : move_map) {
-            char a = pr.first;
-            State U;
-            for (int p : pr.second)
-                U.insert(followpos.at(p).begin(), followpos.at(p).end());
-            int id = state_ids[U];
-            dfa_trans[i][a] = id;
+            dfa_trans[next][pr.first] = found.first->second;
         }
     }
     // Find accept state(s)
-    for (auto pr : dfa_states) {
-        State T = pr.first;
-        if (T.count(marker_pos)) {
-            accept_state = pr.second;
+    for (int id : states_in_set_order(states)) {
+        if (states[id].count(marker_pos)) {
+            accept_state = id;
             break;
         }
     }
+    dfa_states = move(states);
 }
 
 // Helper to print a set of ints as {x1,x2,...}
-void print_set(const set<int>& S) {
+void print_set(const PosSet& S) {
     cout << "{";
     bool comma = false;
-    for (int x : S) {
+    S.for_each([&](int x) {
         if (comma) cout << ",";
         cout << x;
         comma = true;
-    }
+    });
     cout << "}";
 }
 
@@ -271,7 +206,7 @@ void print_first_last(const vector<Node*>& leaves) {
 }
 
 // Print followpos table
-void print_follow(const vector<Node*>& leaves, const map<int, set<int>>& followpos) {
+void print_follow(const vector<Node*>& leaves, const vector<PosSet>& followpos) {
     cout << "\n"
          << left << setw(10) << "Position"
          << setw(8) << "Symbol"
@@ -281,13 +216,13 @@ void print_follow(const vector<Node*>& leaves, const map<int, set<int>>& followp
     for (auto* leaf : leaves) {
         cout << right << setw(8) << leaf->position << "  "
              << left << setw(6) << leaf->symbol;
-        cout << setw(15); print_set(followpos.at(leaf->position));
+        cout << setw(15); print_set(followpos[leaf->position]);
         cout << "\n";
     }
 }
 
 // Print DFA transition table with padding fix to avoid length_error
-void print_dfa(const map<State, int, StateCmp>& dfa_states,
+void print_dfa(const vector<State>& dfa_states,
                const vector<map<char, int>>& dfa_trans,
                int accept_state, const vector<Node*>& leaves) {
     set<char> alphabet;
@@ -301,16 +236,15 @@ void print_dfa(const map<State, int, StateCmp>& dfa_states,
     cout << setw(8) << "Accept" << "\n";
     cout << string(7 + 18 + 7 * alphabet.size() + 8, '-') << "\n";
 
-    for (auto pr : dfa_states) {
-        int id = pr.second;
+    for (int id : states_in_set_order(dfa_states)) {
         cout << right << setw(5) << id << "   ";
-        print_set(pr.first);
+        print_set(dfa_states[id]);
 
         int set_width = 16; // Adjust if you expect larger sets
         int len = 2; // for "{}"
-        for (int x : pr.first) {
+        dfa_states[id].for_each([&](int x) {
             len += to_string(x).size() + 1; // +1 for comma
-        }
+        });
         int pad = set_width - len;
         if (pad < 0) pad = 0;  // *** This line prevents string length errors ***
         cout << string(pad, ' ');
@@ -325,7 +259,518 @@ void print_dfa(const map<State, int, StateCmp>& dfa_states,
     }
 }
 
-int main() {
+// Input symbols of the DFA, in the order the tables list them
+vector<char> dfa_alphabet(const vector<Node*>& leaves) {
+    set<char> alphabet;
+    for (auto* leaf : leaves)
+        if (leaf->symbol != '#') alphabet.insert(leaf->symbol);
+    return vector<char>(alphabet.begin(), alphabet.end());
+}
+
+// Hopcroft-minimizes the DFA; every state holding the end marker accepts
+MinimizedDFA minimize_dfa(const vector<State>& dfa_states, const vector<map<char, int>>& dfa_trans,
+                          const vector<Node*>& leaves, const vector<char>& alphabet) {
+    int marker_pos = -1;
+    for (auto* leaf : leaves)
+        if (leaf->symbol == '#') marker_pos = leaf->position;
+
+    vector<vector<int>> trans(dfa_states.size(), vector<int>(alphabet.size(), -1));
+    vector<bool> accepting(dfa_states.size());
+    for (size_t id = 0; id < dfa_states.size(); ++id) {
+        for (size_t c = 0; c < alphabet.size(); ++c) {
+            auto it = dfa_trans[id].find(alphabet[c]);
+            if (it != dfa_trans[id].end()) trans[id][c] = it->second;
+        }
+        accepting[id] = dfa_states[id].count(marker_pos);
+    }
+    return hopcroft_minimize(trans, accepting, 0);
+}
+
+// Print the minimized table; "Merges" lists the raw states each state replaces
+void print_minimized_dfa(const MinimizedDFA& m, const vector<char>& alphabet) {
+    cout << "\n";
+    cout << left << setw(7) << "State"
+         << setw(18) << "Merges";
+    for (char a : alphabet) cout << setw(7) << a;
+    cout << setw(8) << "Accept" << "\n";
+    cout << string(7 + 18 + 7 * alphabet.size() + 8, '-') << "\n";
+
+    for (int id = 0; id < m.size(); ++id) {
+        PosSet merged;
+        for (size_t s = 0; s < m.class_of.size(); ++s)
+            if (m.class_of[s] == id) merged.insert(int(s));
+        cout << right << setw(5) << id << "   ";
+        print_set(merged);
+        int len = 2;
+        merged.for_each([&](int x) { len += to_string(x).size() + 1; });
+        cout << string(max(16 - len, 0), ' ');
+
+        for (size_t c = 0; c < alphabet.size(); ++c) {
+            if (m.trans[id][c] >= 0) cout << setw(7) << m.trans[id][c];
+            else cout << setw(7) << "-";
+        }
+        cout << setw(8) << (m.accepting[id] ? "Yes" : "No") << "\n";
+    }
+
+    int dropped = 0;
+    for (int c : m.class_of) dropped += c < 0;
+    cout << "\nMinimized: " << m.class_of.size() << " -> " << m.size() << " states ("
+         << m.class_of.size() - m.size() << " fewer";
+    if (dropped) cout << ", " << dropped << " of them dead";
+    cout << ")\n";
+}
+
+// ---------- Leftmost-longest search ----------
+// find_all() for the matchers below. A search from i runs until the DFA dies,
+// so one that stays live without accepting (a.*b over text with no b) costs
+// O(n), and every later start would pay it again: O(n^2). The DFA is
+// deterministic, so once a search is in the state an earlier search had at
+// the same position after that search's last accept, it cannot accept again
+// and stops there. The dead-end tail of the search that reached furthest is
+// kept as runs of equal states, which makes such text linear. Searches still
+// live after quiet_bytes are the only ones that pay for this. Text that keeps
+// several dead-end paths going that never meet can still cost O(n^2).
+//
+// "State at position p" is the state after reading buf[p - 1].
+class LeftmostLongest {
+public:
+    // Forget the recorded states, e.g. when the matcher renumbers its states
+    // during a search
+    void clear() {
+        tail.clear();
+        path.clear();
+        tail_end = 0;
+    }
+
+    // Leftmost-longest, non-overlapping, non-empty matches; calls
+    // on_match(offset, length) for each and returns how many there were.
+    // step(state, byte) is the next state, 0 when dead; it may clear().
+    template <class Step, class Accepting, class F>
+    size_t find_all(string_view buf, int32_t start, Step&& step, Accepting&& accepting, F&& on_match) {
+        size_t count = 0, i = 0, n = buf.size();
+        clear();
+        max_runs = max(min_runs, n / 8);
+        while (i < n) {
+            int32_t state = start;
+            size_t end = 0;  // end of the longest match from i so far
+            size_t j = i, quiet = min(n, i + quiet_bytes);
+            for (; j < quiet; ++j) {  // most searches die within a few bytes
+                state = step(state, (unsigned char)buf[j]);
+                if (!state) break;
+                if (accepting(state)) end = j + 1;
+            }
+            if (state && j < n) end = follow(buf, j, state, end, step, accepting);
+            if (end) {
+                on_match(i, end - i);
+                ++count;
+                i = end;
+            } else ++i;
+        }
+        return count;
+    }
+
+private:
+    static constexpr size_t quiet_bytes = 4;
+    static constexpr size_t record_after = 16;  // bytes after an accept before the path starts
+    // A path stops being recorded after max_runs runs, and a search that gets
+    // past the end of the tail runs on, so text whose state changes at every
+    // byte can make about n / max_runs searches run to the end
+    static constexpr size_t min_runs = size_t(1) << 16;
+    size_t max_runs = min_runs;
+
+    vector<pair<size_t, int32_t>> tail, path;  // runs (first position, state); tail is last run first
+    size_t tail_end = 0;                       // the tail covers positions below this
+
+    // The rest of a search that is in state at position j; returns the end of
+    // its longest match, end if it has none past j
+    template <class Step, class Accepting>
+    size_t follow(string_view buf, size_t j, int32_t state, size_t end, Step&& step, Accepting&& accepting) {
+        size_t n = buf.size();
+        size_t stop = n + 1;  // one past the last position the search was live at
+        size_t met = 0;       // position where it met the tail, 0 if it did not
+        size_t cap = 0;       // if set, the path stops short of the search here
+        int32_t last = 0;     // state of the last run in the path
+        path.clear();
+        while (tail.size() > 1 && tail[tail.size() - 2].first <= j + 1) tail.pop_back();
+        size_t r = tail.size() - 1;  // run that may hold the position
+        for (; j < n; ++j) {
+            state = step(state, (unsigned char)buf[j]);
+            if (!state) {
+                stop = j + 1;
+                break;
+            }
+            size_t pos = j + 1;
+            if (pos < tail_end) {
+                while (r && tail[r - 1].first <= pos) --r;
+                if (tail[r].first <= pos && tail[r].second == state) {
+                    met = pos;
+                    break;
+                }
+            }
+            // accepting states can be frequent and unpredictable, so no branch:
+            // the path starts record_after bytes after the last accept, and
+            // runs from before it are dropped when the next one is added
+            end = accepting(state) ? pos : end;
+            if (pos >= end + record_after && state != last) {
+                if (!path.empty() && path.back().first < end) {
+                    path.clear();
+                    cap = 0;
+                }
+                if (path.size() < max_runs) path.push_back({pos, state});
+                else if (!cap) cap = pos;
+                last = state;
+            }
+        }
+        if (!path.empty() && path.back().first < end) path.clear();
+        else if (cap) remember(0, cap, r);
+        else remember(met, stop, r);
+        return end;
+    }
+
+    // Keep the search's dead-end path: in front of the tail run r it met, or
+    // instead of the tail if it reached further
+    void remember(size_t met, size_t path_end, size_t r) {
+        if (path.empty()) return;
+        if (met) {
+            tail.resize(r + 1);
+            tail[r].first = met;
+            if (tail[r].second == path.back().second) tail.pop_back();
+        } else if (path_end > tail_end) {
+            tail.clear();
+            tail_end = path_end;
+        } else return;
+        tail.insert(tail.end(), path.rbegin(), path.rend());
+        if (tail.size() > 2 * max_runs) {  // drop the far end
+            tail.erase(tail.begin(), tail.end() - max_runs);
+            tail_end = tail.front().first;
+        }
+    }
+};
+
+// ---------- Compiled matcher ----------
+// compile() turns a pattern into a flat transition table: row s holds, for
+// every byte class, the offset of the next state's row, so a step is
+//   state = table[state + byte_class[byte]]
+// Bytes that behave the same in every state share a class, which keeps rows
+// short. Row 0 is the dead state; accepting rows come last, so "accepts" is
+// one comparison against first_accept.
+struct AlignedFree {
+    void operator()(void *p) const { free(p); }
+};
+
+struct CompiledDFA {
+    array<uint8_t, 256> byte_class{};
+    int classes = 1;                       // row width
+    int states = 1;                        // including the dead state
+    int32_t start = 0, first_accept = 0;   // row offsets
+    unique_ptr<int32_t[], AlignedFree> table;
+
+    // Whole-string match
+    bool match(string_view s) const {
+        int32_t state = start;
+        for (unsigned char c : s) {
+            state = table[state + byte_class[c]];
+            if (!state) return false;
+        }
+        return state >= first_accept;
+    }
+
+    int32_t next(int32_t state, unsigned char c) const { return table[state + byte_class[c]]; }
+    bool accepting(int32_t state) const { return state >= first_accept; }
+
+    // Leftmost-longest, non-overlapping, non-empty matches; calls
+    // on_match(offset, length) for each and returns how many there were
+    template <class F>
+    size_t find_all(string_view buf, F &&on_match) const {
+        LeftmostLongest search;
+        return search.find_all(
+            buf, start, [&](int32_t state, unsigned char c) { return next(state, c); },
+            [&](int32_t state) { return accepting(state); }, on_match);
+    }
+    size_t find_all(string_view buf) const {
+        return find_all(buf, [](size_t, size_t) {});
+    }
+
+    size_t table_bytes() const { return size_t(states) * classes * sizeof(int32_t); }
+};
+
+// Compiles the (minimized) DFA built from the tree
+CompiledDFA compile_dfa(const vector<State>& dfa_states, const vector<map<char, int>>& dfa_trans,
+                        const vector<Node*>& leaves) {
+    vector<char> alphabet = dfa_alphabet(leaves);
+    MinimizedDFA m = minimize_dfa(dfa_states, dfa_trans, leaves, alphabet);
+    CompiledDFA dfa;
+
+    // byte classes: symbols with the same column share one; class 0 is
+    // every byte that leads nowhere
+    map<vector<int>, int> column_class;
+    vector<int> class_column(1, -1);  // alphabet index of a symbol in each class
+    for (size_t c = 0; c < alphabet.size(); ++c) {
+        vector<int> column(m.size());
+        bool live = false;
+        for (int q = 0; q < m.size(); ++q) {
+            column[q] = m.trans[q][c];
+            live |= column[q] >= 0;
+        }
+        if (!live) continue;
+        auto found = column_class.emplace(column, int(class_column.size()));
+        if (found.second) class_column.push_back(int(c));
+        dfa.byte_class[(unsigned char)alphabet[c]] = uint8_t(found.first->second);
+    }
+    dfa.classes = int(class_column.size());
+
+    // rows: dead, then non-accepting, then accepting states
+    vector<int> row(m.size());
+    int next_row = 1;
+    for (int pass = 0; pass < 2; ++pass)
+        for (int q = 0; q < m.size(); ++q)
+            if (m.accepting[q] == (pass == 1)) {
+                if (pass == 1 && !dfa.first_accept) dfa.first_accept = next_row * dfa.classes;
+                row[q] = next_row++;
+            }
+    if (!dfa.first_accept) dfa.first_accept = next_row * dfa.classes;  // nothing accepts
+    dfa.states = next_row;
+    dfa.start = m.start >= 0 ? row[m.start] * dfa.classes : 0;
+
+    size_t bytes = (dfa.table_bytes() + 63) / 64 * 64;
+    dfa.table.reset((int32_t *)aligned_alloc(64, bytes));
+    memset(dfa.table.get(), 0, bytes);
+    for (int q = 0; q < m.size(); ++q)
+        for (int k = 1; k < dfa.classes; ++k) {
+            int t = m.trans[q][class_column[k]];
+            dfa.table[row[q] * dfa.classes + k] = t >= 0 ? row[t] * dfa.classes : 0;
+        }
+    return dfa;
+}
+
+// Pattern in the same syntax the program reads, e.g. "((a|b)*.a.b.b).#"
+CompiledDFA compile(const string& pattern) {
+    vector<Node*> leaves;
+    Node* root = buildSyntaxTree(regexToPostfix(pattern), leaves);
+    compute_nullable_first_last(root);
+    vector<PosSet> followpos(leaves.size() + 1);
+    compute_followpos(root, followpos);
+
+    vector<State> dfa_states;
+    vector<map<char, int>> dfa_trans;
+    int accept_state = -1;
+    construct_dfa(root, leaves, followpos, dfa_states, dfa_trans, accept_state);
+    return compile_dfa(dfa_states, dfa_trans, leaves);
+}
+
+// ---------- Lazy DFA ----------
+// Matches without building the DFA up front: a state is made from followpos
+// the first time an input byte leads to it, and kept in a cache of at most
+// max_states states. When the cache is full it is flushed and refilled from
+// the current state on, so memory stays bounded however many states the
+// pattern has; input that keeps to a few hot states runs at table speed.
+//
+// Layout as in CompiledDFA (row offsets, row 0 dead), plus row 1 = start and
+// UNKNOWN for transitions not built yet. Each symbol has its own class.
+class LazyDFA {
+public:
+    size_t states_built = 0, flushes = 0;
+
+    LazyDFA(const vector<Node*>& leaves, Node* root, const vector<PosSet>& followpos, size_t max_states = 4096)
+        : followpos(followpos), symbol(position_symbols(leaves)), start_set(root->firstpos),
+          max_states(max(max_states, size_t(3))) {
+        for (auto* leaf : leaves)
+            if (leaf->symbol == '#') marker_pos = leaf->position;
+        class_symbol.push_back(0);
+        for (char a : dfa_alphabet(leaves)) {
+            byte_class[(unsigned char)a] = uint8_t(class_symbol.size());
+            class_symbol.push_back(a);
+        }
+        classes = int(class_symbol.size());
+        flush();
+        flushes = 0;
+    }
+
+    size_t cached_states() const { return sets.size(); }
+
+    // next() may flush the cache, which renumbers all states but the dead and
+    // start ones
+    int32_t start() const { return classes; }
+    int32_t next(int32_t state, unsigned char c) { return step(state, byte_class[c]); }
+    bool accepting(int32_t state) const { return accept[state]; }
+
+    bool match(string_view s) {
+        int32_t state = classes;
+        for (unsigned char c : s) {
+            state = step(state, byte_class[c]);
+            if (!state) return false;
+        }
+        return accept[state];
+    }
+
+    // Same matches as CompiledDFA::find_all. A flush forgets the dead-end
+    // states too, so with a cache too small for the states a search goes
+    // through, text that stays live without accepting is O(n^2) again.
+    template <class F>
+    size_t find_all(string_view buf, F &&on_match) {
+        return dead_ends.find_all(
+            buf, start(), [&](int32_t state, unsigned char c) { return next(state, c); },
+            [&](int32_t state) { return accepting(state); }, on_match);
+    }
+    size_t find_all(string_view buf) {
+        return find_all(buf, [](size_t, size_t) {});
+    }
+
+private:
+    static constexpr int32_t UNKNOWN = -1;
+
+    vector<PosSet> followpos;
+    vector<char> symbol;                  // by position
+    PosSet start_set;
+    int marker_pos = -1;
+    array<uint8_t, 256> byte_class{};
+    vector<char> class_symbol;            // class 0: bytes that lead nowhere
+    int classes = 1;
+    size_t max_states;
+
+    vector<const PosSet*> sets;           // by row; the keys of row_of
+    unordered_map<PosSet, int32_t, PosSetHash> row_of;  // set -> row offset
+    vector<int32_t> trans;
+    vector<uint8_t> accept;               // by row offset
+    LeftmostLongest dead_ends;            // by row offset too; flush() clears it
+
+    int32_t step(int32_t state, uint8_t cls) {
+        int32_t next = trans[state + cls];
+        return next != UNKNOWN ? next : build(state, cls);
+    }
+
+    // Row offset of the state for set T, adding it if it is not cached
+    int32_t add(const PosSet& T) {
+        auto found = row_of.emplace(T, int32_t(sets.size()) * classes);
+        if (!found.second) return found.first->second;
+        int32_t row = found.first->second;
+        sets.push_back(&found.first->first);  // map nodes do not move
+        trans.resize(trans.size() + classes, UNKNOWN);
+        accept.resize(trans.size(), 0);
+        trans[row] = 0;  // class 0 always dies
+        accept[row] = T.count(marker_pos);
+        ++states_built;
+        return row;
+    }
+
+    // Empty the cache but for the dead and start states
+    void flush() {
+        sets.clear();
+        row_of.clear();
+        trans.clear();
+        accept.clear();
+        dead_ends.clear();
+        ++flushes;
+        add(PosSet());
+        for (int k = 0; k < classes; ++k) trans[k] = 0;
+        add(start_set);
+    }
+
+    int32_t build(int32_t state, uint8_t cls) {
+        PosSet next;
+        char a = class_symbol[cls];
+        sets[state / classes]->for_each([&](int p) {
+            if (symbol[p] == a) next.insert(followpos[p]);
+        });
+        auto cached = row_of.find(next);
+        if (cached != row_of.end()) return trans[state + cls] = cached->second;
+        if (sets.size() >= max_states) {
+            flush();  // `state` is gone; matching goes on from the new one
+            return add(next);
+        }
+        int32_t row = add(next);
+        trans[state + cls] = row;
+        return row;
+    }
+};
+
+// ---------- Benchmark (--bench MB) ----------
+// Text drawn from the pattern's symbols
+string bench_text(const vector<Node*>& leaves, size_t megabytes) {
+    vector<char> alphabet = dfa_alphabet(leaves);
+    string text(alphabet.empty() ? 0 : megabytes << 20, 0);
+    mt19937 rng(42);
+    for (char& ch : text) ch = alphabet[rng() % alphabet.size()];
+    return text;
+}
+
+// Text on which a search stays live without accepting for as long as the
+// pattern allows, the worst case for find_all: each byte is drawn from the
+// symbols that lead to such a state, starting over from the start state when
+// there are none. Empty if no first byte does.
+template <class Step, class Accepting>
+string dead_end_text(size_t bytes, int32_t start, const vector<char>& alphabet, Step&& step, Accepting&& accepting) {
+    string text;
+    mt19937 rng(42);
+    vector<pair<char, int32_t>> moves;
+    int32_t state = start;
+    while (text.size() < bytes) {
+        moves.clear();
+        for (char a : alphabet) {
+            int32_t next = step(state, (unsigned char)a);
+            if (next && !accepting(next)) moves.push_back({a, next});
+        }
+        if (moves.empty()) {
+            if (state == start) break;
+            state = start;
+            continue;
+        }
+        auto [a, next] = moves[rng() % moves.size()];
+        text += a;
+        state = next;
+    }
+    return text;
+}
+
+// Times search(), which returns the number of matches in text
+template <class Search>
+void report_throughput(const char* name, const string& text, Search&& search) {
+    auto t0 = chrono::steady_clock::now();
+    size_t matches = search();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    cout << "  " << left << setw(10) << name << right << setw(10) << matches << " matches  "
+         << fixed << setprecision(3) << secs << " s  " << setprecision(2)
+         << text.size() / secs / 1e9 << " GB/s\n";
+    cout.unsetf(ios::fixed);
+}
+
+// Leftmost-longest search walking the vector<map> table, for comparison
+size_t find_all_map(const string& text, const vector<map<char, int>>& dfa_trans,
+                    const vector<State>& dfa_states, const vector<Node*>& leaves) {
+    int marker_pos = -1;
+    for (auto* leaf : leaves)
+        if (leaf->symbol == '#') marker_pos = leaf->position;
+    // state s + 1 is DFA state s, so that 0 is dead
+    LeftmostLongest search;
+    return search.find_all(
+        text, 1,
+        [&](int32_t state, unsigned char c) {
+            auto it = dfa_trans[state - 1].find(char(c));
+            return it == dfa_trans[state - 1].end() ? 0 : it->second + 1;
+        },
+        [&](int32_t state) { return dfa_states[state - 1].count(marker_pos) != 0; }, [](size_t, size_t) {});
+}
+
+void print_lazy_stats(const LazyDFA& lazy) {
+    cout << "  lazy DFA built " << lazy.states_built << " states, " << lazy.cached_states()
+         << " cached, " << lazy.flushes << " cache flushes\n";
+}
+
+int main(int argc, char *argv[]) {
+    bool minimize = false;  // --minimize: also print the Hopcroft-minimized table
+    bool match_lines = false;  // --match: then test each further input line
+    size_t bench_mb = 0;    // --bench MB: time the matchers
+    bool lazy = false;      // --lazy: match with the lazy DFA only; the DFA table is not built
+    size_t cache_states = 4096;  // --cache N: lazy DFA cache size in states
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--minimize") minimize = true;
+        else if (arg == "--match") match_lines = true;
+        else if (arg == "--bench" && a + 1 < argc) bench_mb = atoi(argv[++a]);
+        else if (arg == "--lazy") lazy = true;
+        else if (arg == "--cache" && a + 1 < argc) cache_states = atoi(argv[++a]);
+    }
+
     cout << "Enter the regular expression (fully parenthesized with explicit '.' for concatenation, ending with .#):\n";
     string regex;
     getline(cin, regex);
@@ -337,19 +782,79 @@ int main() {
 
     compute_nullable_first_last(root);
 
-    map<int, set<int>> followpos;
-    for (auto* leaf : leaves) followpos[leaf->position] = set<int>();
+    vector<PosSet> followpos(leaves.size() + 1);
     compute_followpos(root, followpos);
 
     print_first_last(leaves);
     print_follow(leaves, followpos);
 
-    map<State, int, StateCmp> dfa_states;
+    if (lazy) {
+        LazyDFA lazy_dfa(leaves, root, followpos, cache_states);
+        if (bench_mb) {
+            string text = bench_text(leaves, bench_mb);
+            cout << "\nfind_all over " << bench_mb << " MB:\n";
+            report_throughput("lazy", text, [&] { return lazy_dfa.find_all(text); });
+            print_lazy_stats(lazy_dfa);
+
+            LazyDFA walker(leaves, root, followpos, SIZE_MAX);  // never flushes, so its states stay valid
+            string dead_end = dead_end_text(text.size(), walker.start(), dfa_alphabet(leaves),
+                                            [&](int32_t state, unsigned char c) { return walker.next(state, c); },
+                                            [&](int32_t state) { return walker.accepting(state); });
+            if (!dead_end.empty()) {
+                cout << "find_all over " << bench_mb << " MB that stays live without accepting:\n";
+                report_throughput("lazy", dead_end, [&] { return lazy_dfa.find_all(dead_end); });
+            }
+        }
+        if (match_lines) {
+            cout << "\nEnter strings to match, one per line:\n";
+            string line;
+            while (getline(cin, line)) cout << line << ": " << (lazy_dfa.match(line) ? "match" : "no match") << "\n";
+        }
+        return 0;
+    }
+
+    vector<State> dfa_states;
     vector<map<char, int>> dfa_trans;
     int accept_state = -1;
     construct_dfa(root, leaves, followpos, dfa_states, dfa_trans, accept_state);
 
     print_dfa(dfa_states, dfa_trans, accept_state, leaves);
 
+    if (minimize) {
+        vector<char> alphabet = dfa_alphabet(leaves);
+        print_minimized_dfa(minimize_dfa(dfa_states, dfa_trans, leaves, alphabet), alphabet);
+    }
+
+    if (match_lines || bench_mb) {
+        CompiledDFA dfa = compile_dfa(dfa_states, dfa_trans, leaves);
+        if (bench_mb) {
+            string text = bench_text(leaves, bench_mb);
+            LazyDFA lazy_dfa(leaves, root, followpos, cache_states);
+            cout << "\nCompiled matcher: " << dfa.states << " states, " << dfa.classes << " byte classes, "
+                 << dfa.table_bytes() << " table bytes\n";
+            cout << "find_all over " << bench_mb << " MB:\n";
+            report_throughput("compiled", text, [&] { return dfa.find_all(text); });
+            report_throughput("lazy", text, [&] { return lazy_dfa.find_all(text); });
+            report_throughput("map table", text, [&] { return find_all_map(text, dfa_trans, dfa_states, leaves); });
+            print_lazy_stats(lazy_dfa);
+
+            string dead_end = dead_end_text(text.size(), dfa.start, dfa_alphabet(leaves),
+                                            [&](int32_t state, unsigned char c) { return dfa.next(state, c); },
+                                            [&](int32_t state) { return dfa.accepting(state); });
+            if (!dead_end.empty()) {
+                cout << "find_all over " << bench_mb << " MB that stays live without accepting:\n";
+                report_throughput("compiled", dead_end, [&] { return dfa.find_all(dead_end); });
+                report_throughput("lazy", dead_end, [&] { return lazy_dfa.find_all(dead_end); });
+                report_throughput("map table", dead_end,
+                                  [&] { return find_all_map(dead_end, dfa_trans, dfa_states, leaves); });
+            }
+        }
+        if (match_lines) {
+            cout << "\nEnter strings to match, one per line:\n";
+            string line;
+            while (getline(cin, line)) cout << line << ": " << (dfa.match(line) ? "match" : "no match") << "\n";
+        }
+    }
+
     return 0;
 }
@@ -0,0 +1,160 @@
+// Hopcroft DFA minimization, shared by DFA.cpp, ALL-CODES/nayachar.cpp and
+// ALL-CODES/neofour.cpp (--minimize), and LEXER_GENERATOR.cpp.
+//
+//   MinimizedDFA m = hopcroft_minimize(trans, accepting, start);
+//   MinimizedDFA m = hopcroft_minimize(trans, label, start);
+//   trans[s][c]     next state of s on symbol index c, or -1 for none
+//   label[s]        what s accepts (a lexer's token number), or -1 if nothing;
+//                   states with different labels are never merged
+//   m.class_of[s]   new state of old state s; -1 if s can never reach an
+//                   accepting state (it is merged into the implicit dead state)
+//   m.trans[q][c]   next new state, or -1
+//   m.label[q]      label of new state q (0 / -1 for the accepting form)
+//
+// Missing transitions go to an implicit dead state, so the input may be a
+// partial DFA; the result is partial again, with the dead state left out.
+// New states are numbered by the smallest old state in them, so the start
+// state keeps its number when it is 0. Runs in O(n k log n) for n states and
+// k symbols.
+#ifndef DFA_MINIMIZE_H
+#define DFA_MINIMIZE_H
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+struct MinimizedDFA {
+    std::vector<int> class_of;
+    std::vector<std::vector<int>> trans;
+    std::vector<bool> accepting;
+    std::vector<int> label;
+    int start = -1;
+
+    int size() const { return int(trans.size()); }
+};
+
+inline MinimizedDFA hopcroft_minimize(const std::vector<std::vector<int>> &trans,
+                                      const std::vector<int> &label, int start) {
+    int n = int(trans.size()) + 1;  // state n - 1 is the dead state
+    int dead = n - 1;
+    auto label_of = [&](int s) { return s == dead || label[s] < 0 ? -1 : label[s]; };
+    int k = trans.empty() ? 0 : int(trans[0].size());
+    auto next = [&](int s, int c) {
+        int t = s == dead ? -1 : trans[s][c];
+        return t < 0 ? dead : t;
+    };
+
+    // inverse[c][t]: states that go to t on c
+    std::vector<std::vector<std::vector<int>>> inverse(k, std::vector<std::vector<int>>(n));
+    for (int s = 0; s < n; ++s)
+        for (int c = 0; c < k; ++c) inverse[c][next(s, c)].push_back(s);
+
+    // Blocks are ranges of elems; the first marked[b] entries of block b are
+    // the states marked while processing the current splitter. The initial
+    // blocks group the states by label.
+    std::vector<int> elems(n), loc(n), block_of(n), first, last, marked;
+    std::iota(elems.begin(), elems.end(), 0);
+    std::stable_sort(elems.begin(), elems.end(), [&](int a, int b) { return label_of(a) < label_of(b); });
+    for (int i = 0; i < n; ++i) {
+        int s = elems[i];
+        if (i == 0 || label_of(s) != label_of(elems[i - 1])) {
+            if (i) last.push_back(i);
+            first.push_back(i);
+            marked.push_back(0);
+        }
+        loc[s] = i;
+        block_of[s] = int(first.size()) - 1;
+    }
+    last.push_back(n);
+
+    // Splitters (block, symbol) waiting to be processed
+    std::vector<std::pair<int, int>> work;
+    std::vector<std::vector<char>> waiting(first.size(), std::vector<char>(k, 0));
+    auto push = [&](int b, int c) {
+        work.push_back({b, c});
+        waiting[b][c] = 1;
+    };
+    // every initial block but the largest is a splitter
+    int largest = 0;
+    for (int b = 1; b < int(first.size()); ++b)
+        if (last[b] - first[b] >= last[largest] - first[largest]) largest = b;
+    for (int b = 0; b < int(first.size()); ++b)
+        if (b != largest)
+            for (int c = 0; c < k; ++c) push(b, c);
+
+    std::vector<int> preds, touched;
+    while (!work.empty()) {
+        auto [splitter, c] = work.back();
+        work.pop_back();
+        waiting[splitter][c] = 0;
+
+        preds.clear();
+        for (int i = first[splitter]; i < last[splitter]; ++i)
+            for (int p : inverse[c][elems[i]]) preds.push_back(p);
+
+        // move each predecessor to the marked front of its block
+        touched.clear();
+        for (int p : preds) {
+            int b = block_of[p];
+            if (!marked[b]) touched.push_back(b);
+            int to = first[b] + marked[b]++;
+            int q = elems[to];
+            std::swap(elems[to], elems[loc[p]]);
+            loc[q] = loc[p];
+            loc[p] = to;
+        }
+
+        for (int b : touched) {
+            int m = marked[b];
+            marked[b] = 0;
+            if (m == last[b] - first[b]) continue;  // every state moved: no split
+            // the marked part becomes block z, the rest stays b
+            int z = int(first.size());
+            first.push_back(first[b]);
+            last.push_back(first[b] + m);
+            marked.push_back(0);
+            waiting.emplace_back(k, 0);
+            first[b] += m;
+            for (int i = first[z]; i < last[z]; ++i) block_of[elems[i]] = z;
+            for (int d = 0; d < k; ++d) {
+                if (waiting[b][d]) push(z, d);
+                else if (last[z] - first[z] < last[b] - first[b]) push(z, d);
+                else push(b, d);
+            }
+        }
+    }
+
+    // Number the blocks by their smallest old state; the dead block is dropped
+    MinimizedDFA m;
+    m.class_of.assign(n - 1, -1);
+    std::vector<int> block_id(first.size(), -1);
+    std::vector<int> rep;
+    for (int s = 0; s < n - 1; ++s) {
+        int b = block_of[s];
+        if (b == block_of[dead]) continue;
+        if (block_id[b] < 0) {
+            block_id[b] = int(rep.size());
+            rep.push_back(s);
+        }
+        m.class_of[s] = block_id[b];
+    }
+    for (int s : rep) {
+        std::vector<int> row(k, -1);
+        for (int c = 0; c < k; ++c) row[c] = block_id[block_of[next(s, c)]];
+        m.trans.push_back(row);
+        m.accepting.push_back(label_of(s) >= 0);
+        m.label.push_back(label_of(s));
+    }
+    m.start = start >= 0 && start < n - 1 ? m.class_of[start] : -1;
+    return m;
+}
+
+inline MinimizedDFA hopcroft_minimize(const std::vector<std::vector<int>> &trans,
+                                      const std::vector<bool> &accepting, int start) {
+    std::vector<int> label(accepting.size());
+    for (size_t s = 0; s < accepting.size(); ++s) label[s] = accepting[s] ? 0 : -1;
+    return hopcroft_minimize(trans, label, start);
+}
+
+#endif
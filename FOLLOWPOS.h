@@ -0,0 +1,128 @@
+// Followpos construction of a DFA straight from a regex syntax tree, shared by
+// DFA.cpp and LEXER_GENERATOR.cpp.
+//
+// Each program keeps its own Node (one character per leaf in DFA.cpp, a byte
+// set per leaf plus per-token END markers in the generator) with these members:
+//   Type type;  Node *left, *right;  Node *child;   (OR / CAT, STAR)
+//   int position;  bool nullable;  PosSet firstpos, lastpos;
+// and numbers its LEAF / END positions before:
+//   compute_nullable_first_last(root);
+//   vector<PosSet> followpos(last_position + 1);
+//   compute_followpos(root, followpos);
+// A DFA state is then a PosSet, looked up in an unordered_map with PosSetHash.
+#ifndef FOLLOWPOS_H
+#define FOLLOWPOS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Node types (END marks the end of a token's pattern; EMPTY matches the empty string)
+enum Type { LEAF, END, EMPTY, OR, CAT, STAR };
+
+// Set of positions as a bitset: bit p is position p. Union is a word-wise OR,
+// and equal sets compare (and hash) equal whatever their word counts.
+struct PosSet {
+    std::vector<uint64_t> words;
+
+    void insert(int p) {
+        if (size_t(p / 64) >= words.size()) words.resize(p / 64 + 1);
+        words[p / 64] |= uint64_t(1) << (p % 64);
+    }
+    void insert(const PosSet &o) {
+        if (o.words.size() > words.size()) words.resize(o.words.size());
+        for (size_t k = 0; k < o.words.size(); ++k) words[k] |= o.words[k];
+    }
+    bool count(int p) const { return size_t(p / 64) < words.size() && (words[p / 64] >> (p % 64) & 1); }
+    bool empty() const {
+        for (uint64_t w : words)
+            if (w) return false;
+        return true;
+    }
+
+    // Calls f(p) for every position, in increasing order
+    template <class F>
+    void for_each(F f) const {
+        for (size_t k = 0; k < words.size(); ++k)
+            for (uint64_t w = words[k]; w; w &= w - 1)
+                f(int(k * 64 + __builtin_ctzll(w)));
+    }
+    std::vector<int> positions() const {
+        std::vector<int> v;
+        for_each([&](int p) { v.push_back(p); });
+        return v;
+    }
+
+    bool operator==(const PosSet &o) const {
+        const std::vector<uint64_t> &a = words.size() >= o.words.size() ? words : o.words;
+        const std::vector<uint64_t> &b = words.size() >= o.words.size() ? o.words : words;
+        for (size_t k = 0; k < a.size(); ++k)
+            if (a[k] != (k < b.size() ? b[k] : 0)) return false;
+        return true;
+    }
+};
+
+struct PosSetHash {
+    size_t operator()(const PosSet &s) const {
+        size_t n = s.words.size();
+        while (n && !s.words[n - 1]) --n;  // trailing zero words do not count
+        uint64_t h = n;
+        for (size_t k = 0; k < n; ++k) h = (h ^ s.words[k]) * 0x9E3779B97F4A7C15ULL;
+        return h ^ (h >> 32);
+    }
+};
+
+// Computes nullable, firstpos, lastpos recursively for all nodes
+template <class Node>
+void compute_nullable_first_last(Node *n) {
+    if (!n) return;
+    if (n->type == LEAF || n->type == END) {
+        n->nullable = false;
+        n->firstpos.insert(n->position);
+        n->lastpos.insert(n->position);
+    } else if (n->type == EMPTY) {
+        n->nullable = true;
+    } else if (n->type == OR) {
+        compute_nullable_first_last(n->left);
+        compute_nullable_first_last(n->right);
+        n->nullable = n->left->nullable || n->right->nullable;
+        n->firstpos.insert(n->left->firstpos);
+        n->firstpos.insert(n->right->firstpos);
+        n->lastpos.insert(n->left->lastpos);
+        n->lastpos.insert(n->right->lastpos);
+    } else if (n->type == CAT) {
+        compute_nullable_first_last(n->left);
+        compute_nullable_first_last(n->right);
+        n->nullable = n->left->nullable && n->right->nullable;
+        n->firstpos = n->left->firstpos;
+        if (n->left->nullable)
+            n->firstpos.insert(n->right->firstpos);
+        n->lastpos = n->right->lastpos;
+        if (n->right->nullable)
+            n->lastpos.insert(n->left->lastpos);
+    } else if (n->type == STAR) {
+        compute_nullable_first_last(n->child);
+        n->nullable = true;
+        n->firstpos = n->child->firstpos;
+        n->lastpos = n->child->lastpos;
+    }
+}
+
+// Computes followpos for all positions; followpos is indexed by position
+template <class Node>
+void compute_followpos(Node *n, std::vector<PosSet> &followpos) {
+    if (!n) return;
+    if (n->type == CAT) {
+        n->left->lastpos.for_each([&](int i) { followpos[i].insert(n->right->firstpos); });
+    } else if (n->type == STAR) {
+        n->child->lastpos.for_each([&](int i) { followpos[i].insert(n->child->firstpos); });
+    }
+    if (n->type == OR || n->type == CAT) {
+        compute_followpos(n->left, followpos);
+        compute_followpos(n->right, followpos);
+    } else if (n->type == STAR) {
+        compute_followpos(n->child, followpos);
+    }
+}
+
+#endif
@@ -0,0 +1,400 @@
+// Throughput benchmark for the lexers in this repo.
+//
+// Generates deterministic C-like corpora, builds lab1.cpp, LEXICAL_TABLE.cpp,
+// ALL-CODES/third.cpp, ALL-CODES/third.c and ALL-CODES/three.c with -O2, and
+// runs each of them over every corpus with the normal file-at-a-time path.
+// For every run it reports wall time, MiB/s, tokens/s, peak RSS and heap
+// allocations per token.
+//
+//   g++ -O2 -o LEXER_BENCH LEXER_BENCH.cpp
+//   ./LEXER_BENCH [--sizes 1,16,128] [--ident 0.6] [--comment 0.1] [--string 0.1]
+//                 [--seed N] [--src DIR] [--work DIR] [--timeout SEC] [--keep]
+//   ./LEXER_BENCH --generate FILE MB     (only write a corpus)
+//
+// Sizes are in MiB (1 to 1024), as are throughput and peak RSS. The densities are per-statement probabilities:
+// --ident is the chance an operand is an identifier rather than a number,
+// --comment the chance of a comment before a statement, --string the chance
+// a statement is a call with a string literal. tokens/s uses the number of
+// tokens the generator wrote, so it is the same denominator for every lexer.
+//
+// Allocations are counted by an LD_PRELOAD library built from this same file
+// with -DALLOC_COUNTER. It wraps malloc/calloc/realloc/memalign, which is also
+// what operator new ends up in.
+//
+// Lexer output goes to /dev/null. third.c and three.c read "test.c" from the
+// current directory, so they run in the work directory with test.c linked to
+// the corpus; third.cpp reads the filename from stdin.
+
+#ifdef ALLOC_COUNTER
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+extern "C" {
+void *__libc_malloc(size_t);
+void *__libc_calloc(size_t, size_t);
+void *__libc_realloc(void *, size_t);
+void *__libc_memalign(size_t, size_t);
+
+static std::atomic<unsigned long long> allocations{0};
+
+void *malloc(size_t n) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(n);
+}
+void *calloc(size_t n, size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+void *realloc(void *p, size_t n) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(p, n);
+}
+void *memalign(size_t align, size_t n) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(align, n);
+}
+void *aligned_alloc(size_t align, size_t n) {
+    return memalign(align, n);
+}
+int posix_memalign(void **out, size_t align, size_t n) {
+    void *p = memalign(align, n);
+    if (!p) return 12; // ENOMEM
+    *out = p;
+    return 0;
+}
+}
+
+// Report the count when the program exits normally
+__attribute__((destructor)) static void reportAllocations() {
+    const char *path = getenv("ALLOC_COUNT_FILE");
+    if (!path) return;
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return;
+    char buf[32];
+    int len = snprintf(buf, sizeof(buf), "%llu\n", allocations.load());
+    if (write(fd, buf, len) < 0) {}
+    close(fd);
+}
+
+#else
+
+#include <bits/stdc++.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+using namespace std;
+
+// ---------- Corpus generator ----------
+struct CorpusOptions {
+    double identDensity = 0.6;
+    double commentDensity = 0.1;
+    double stringDensity = 0.1;
+    uint64_t seed = 1;
+};
+
+class CorpusGenerator {
+public:
+    CorpusGenerator(const CorpusOptions &o) : opt(o), state(o.seed * 0x9E3779B97F4A7C15ull + 1) {}
+
+    // Appends about one line of code to out and returns the tokens it wrote
+    size_t statement(string &out) {
+        size_t tokens = 0;
+        if (chance(opt.commentDensity)) {
+            if (chance(0.5)) {
+                out += "// ";
+                words(out, 3 + pick(8));
+                out += '\n';
+            } else {
+                out += "/* ";
+                words(out, 3 + pick(8));
+                out += "\n   ";
+                words(out, 2 + pick(6));
+                out += " */\n";
+            }
+        }
+        out += "    ";
+        if (chance(opt.stringDensity)) {
+            // printf("...", x);
+            identifier(out);
+            out += "(\"";
+            words(out, 1 + pick(6));
+            out += "\", ";
+            operand(out);
+            out += ");\n";
+            return tokens + 7;
+        }
+        switch (pick(4)) {
+        case 0: // int x = a + b;
+            out += typeNames[pick(4)];
+            out += ' ';
+            identifier(out);
+            out += " = ";
+            tokens += 3 + expression(out);
+            break;
+        case 1: // x += a * b;
+            identifier(out);
+            out += pick(2) ? " = " : " += ";
+            tokens += 2 + expression(out);
+            break;
+        case 2: // if (a < b) x = c;
+            out += pick(2) ? "if (" : "while (";
+            operand(out);
+            out += compareOps[pick(4)];
+            operand(out);
+            out += ") ";
+            identifier(out);
+            out += " = ";
+            tokens += 8 + expression(out);
+            break;
+        default: // return a;
+            out += "return ";
+            tokens += 1 + expression(out);
+            break;
+        }
+        out += ";\n";
+        return tokens + 1;
+    }
+
+private:
+    CorpusOptions opt;
+    uint64_t state;
+
+    static constexpr const char *typeNames[] = {"int", "float", "double", "long"};
+    static constexpr const char *compareOps[] = {" < ", " <= ", " == ", " != "};
+    static constexpr const char *arithOps[] = {" + ", " - ", " * ", " / "};
+    static constexpr const char *wordList[] = {"the", "value", "count", "buffer", "next", "state", "total",
+                                               "index", "result", "node", "length", "offset"};
+
+    uint64_t next() { // xorshift64*
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ull;
+    }
+    size_t pick(size_t n) { return next() % n; }
+    bool chance(double p) { return (next() >> 11) * (1.0 / 9007199254740992.0) < p; }
+
+    void words(string &out, int n) {
+        for (int k = 0; k < n; k++) {
+            if (k) out += ' ';
+            out += wordList[pick(12)];
+        }
+    }
+    void identifier(string &out) {
+        out += wordList[pick(12)];
+        if (pick(2)) {
+            out += '_';
+            out += wordList[pick(12)];
+        }
+        if (pick(3) == 0) out += to_string(pick(100));
+    }
+    void operand(string &out) {
+        if (chance(opt.identDensity)) identifier(out);
+        else if (pick(4) == 0) out += to_string(pick(1000)) + "." + to_string(pick(100));
+        else out += to_string(pick(100000));
+    }
+    size_t expression(string &out) {
+        size_t n = 1 + pick(4);
+        operand(out);
+        for (size_t k = 1; k < n; k++) {
+            out += arithOps[pick(4)];
+            operand(out);
+        }
+        return 2 * n - 1;
+    }
+};
+
+// Writes about megabytes MiB of corpus to path; returns the token count
+size_t generateCorpus(const string &path, size_t megabytes, const CorpusOptions &opt) {
+    FILE *out = fopen(path.c_str(), "wb");
+    if (!out) return 0;
+    CorpusGenerator gen(opt);
+    size_t target = megabytes << 20, written = 0, tokens = 0;
+    string buf;
+    // whole statements only, so the file may run a line past the target
+    while (written + buf.size() < target) {
+        tokens += gen.statement(buf);
+        if (buf.size() >= (1 << 16)) {
+            fwrite(buf.data(), 1, buf.size(), out);
+            written += buf.size();
+            buf.clear();
+        }
+    }
+    fwrite(buf.data(), 1, buf.size(), out);
+    fclose(out);
+    return tokens;
+}
+
+// ---------- Running the lexers ----------
+struct Lexer {
+    string name;
+    string compiler, source;
+    enum { FILENAME_ARG, FILENAME_STDIN, TEST_C } input;
+};
+
+const vector<Lexer> lexers = {
+    {"lab1", "g++", "lab1.cpp", Lexer::FILENAME_ARG},
+    {"LEXICAL_TABLE", "g++", "LEXICAL_TABLE.cpp", Lexer::FILENAME_ARG},
+    {"third.cpp", "g++", "ALL-CODES/third.cpp", Lexer::FILENAME_STDIN},
+    {"third.c", "gcc", "ALL-CODES/third.c", Lexer::TEST_C},
+    {"three.c", "gcc", "ALL-CODES/three.c", Lexer::TEST_C},
+};
+
+struct RunResult {
+    string status = "ok";
+    double seconds = 0;
+    long peakRssKb = 0;
+    long long allocations = -1;
+};
+
+RunResult runLexer(const string &binary, const Lexer &lx, const string &workDir, const string &corpus,
+                   const string &allocLib, int timeout) {
+    RunResult r;
+    string countFile = workDir + "/alloc_count";
+    unlink(countFile.c_str());
+    string stdinFile = workDir + "/stdin.txt";
+    if (lx.input == Lexer::FILENAME_STDIN) ofstream(stdinFile) << corpus << "\n";
+
+    auto t0 = chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (chdir(workDir.c_str()) != 0) _exit(127);
+        int in = open(lx.input == Lexer::FILENAME_STDIN ? stdinFile.c_str() : "/dev/null", O_RDONLY);
+        int out = open("/dev/null", O_WRONLY);
+        dup2(in, 0);
+        dup2(out, 1);
+        dup2(out, 2);
+        if (!allocLib.empty()) {
+            setenv("LD_PRELOAD", allocLib.c_str(), 1);
+            setenv("ALLOC_COUNT_FILE", countFile.c_str(), 1);
+        }
+        alarm(timeout); // survives exec; SIGALRM ends a run that takes too long
+        if (lx.input == Lexer::FILENAME_ARG) execl(binary.c_str(), binary.c_str(), corpus.c_str(), (char *)nullptr);
+        else execl(binary.c_str(), binary.c_str(), (char *)nullptr);
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    r.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    r.peakRssKb = usage.ru_maxrss;
+    if (WIFSIGNALED(status))
+        r.status = WTERMSIG(status) == SIGALRM ? "timeout" : string("signal ") + to_string(WTERMSIG(status));
+    else if (WEXITSTATUS(status) != 0)
+        r.status = "exit " + to_string(WEXITSTATUS(status));
+
+    ifstream counted(countFile);
+    if (!(counted >> r.allocations)) r.allocations = -1;
+    return r;
+}
+
+bool build(const string &compiler, const string &flags, const string &source, const string &output) {
+    string cmd = compiler + " -O2 " + flags + " -o '" + output + "' '" + source + "' 2>/dev/null";
+    return system(cmd.c_str()) == 0;
+}
+
+int main(int argc, char *argv[]) {
+    CorpusOptions opt;
+    vector<size_t> sizes = {1, 16, 128};
+    string srcDir = ".", workDir = "lexbench";
+    int timeout = 600;
+    bool keep = false;
+
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        bool more = a + 1 < argc;
+        if (arg == "--generate" && a + 2 < argc) {
+            string path = argv[a + 1];
+            size_t tokens = generateCorpus(path, atoi(argv[a + 2]), opt);
+            cout << "Wrote " << path << " (" << tokens << " tokens)\n";
+            return tokens ? 0 : 1;
+        } else if (arg == "--sizes" && more) {
+            sizes.clear();
+            stringstream list(argv[++a]);
+            string item;
+            while (getline(list, item, ','))
+                if (!item.empty()) sizes.push_back(stoul(item));
+        }
+        else if (arg == "--ident" && more) opt.identDensity = atof(argv[++a]);
+        else if (arg == "--comment" && more) opt.commentDensity = atof(argv[++a]);
+        else if (arg == "--string" && more) opt.stringDensity = atof(argv[++a]);
+        else if (arg == "--seed" && more) opt.seed = stoull(argv[++a]);
+        else if (arg == "--src" && more) srcDir = argv[++a];
+        else if (arg == "--work" && more) workDir = argv[++a];
+        else if (arg == "--timeout" && more) timeout = atoi(argv[++a]);
+        else if (arg == "--keep") keep = true;
+        else {
+            cerr << "Unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+
+    mkdir(workDir.c_str(), 0755);
+    char resolved[PATH_MAX];
+    if (!realpath(workDir.c_str(), resolved)) {
+        cerr << "Cannot use work directory " << workDir << "\n";
+        return 1;
+    }
+    workDir = resolved;
+
+    // build every lexer and the allocation counter
+    cout << "Building lexers in " << workDir << "\n";
+    vector<string> binaries;
+    for (auto &lx : lexers) {
+        string bin = workDir + "/" + lx.name + ".bin";
+        if (!build(lx.compiler, "", srcDir + "/" + lx.source, bin)) {
+            cout << "  " << lx.name << ": build failed, skipped\n";
+            bin.clear();
+        }
+        binaries.push_back(bin);
+    }
+    string allocLib = workDir + "/liballoccount.so";
+    if (!build("g++", "-shared -fPIC -DALLOC_COUNTER", srcDir + "/LEXER_BENCH.cpp", allocLib)) {
+        cout << "  allocation counter: build failed, allocations not counted\n";
+        allocLib.clear();
+    }
+
+    cout << fixed;
+    cout << "\n" << left << setw(8) << "Size" << setw(16) << "Lexer" << setw(12) << "Status" << right
+         << setw(10) << "Time(s)" << setw(10) << "MiB/s" << setw(12) << "Mtok/s" << setw(14) << "PeakRSS(MiB)"
+         << setw(14) << "Allocs/token" << "\n";
+
+    for (size_t mb : sizes) {
+        string corpus = workDir + "/corpus_" + to_string(mb) + "MB.c";
+        size_t tokens = generateCorpus(corpus, mb, opt);
+        struct stat st;
+        if (!tokens || stat(corpus.c_str(), &st) != 0) {
+            cerr << "Cannot write " << corpus << "\n";
+            return 1;
+        }
+        string testC = workDir + "/test.c";
+        unlink(testC.c_str());
+        if (symlink(corpus.c_str(), testC.c_str()) != 0) cerr << "Cannot link " << testC << "\n";
+
+        for (size_t k = 0; k < lexers.size(); k++) {
+            if (binaries[k].empty()) continue;
+            RunResult r = runLexer(binaries[k], lexers[k], workDir, corpus, allocLib, timeout);
+            double mebibytes = (double)st.st_size / (1 << 20);
+            cout << left << setw(8) << (to_string(mb) + "MiB") << setw(16) << lexers[k].name << setw(12) << r.status
+                 << right << setprecision(3) << setw(10) << r.seconds << setprecision(1) << setw(10)
+                 << mebibytes / r.seconds << setprecision(2) << setw(12) << tokens / 1e6 / r.seconds
+                 << setprecision(1) << setw(14) << r.peakRssKb / 1024.0 << setw(14);
+            if (r.allocations >= 0) cout << setprecision(3) << (double)r.allocations / tokens;
+            else cout << "-";
+            cout << "\n" << flush;
+        }
+
+        unlink(testC.c_str());
+        if (!keep) unlink(corpus.c_str());
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,496 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <bitset>
+#include <iomanip>
+#include <algorithm>
+#include "FOLLOWPOS.h"
+#include "DFA_MINIMIZE.h"
+using namespace std;
+
+// Lexer generator: one regex per token class -> one minimized DFA -> maximal-munch scanner.
+//
+// The DFA is built straight from the regex with the followpos construction of DFA.cpp
+// (FOLLOWPOS.h) and minimized with its Hopcroft pass (DFA_MINIMIZE.h).
+// All token patterns are joined as (r1).#1 | (r2).#2 | ... where #k is an end marker
+// for token k, so a DFA state accepts token k when it contains the position of #k.
+//
+// Spec file, one token per line:   NAME PRIORITY REGEX
+//   - a lower PRIORITY wins when two tokens match the same longest lexeme
+//     (equal priorities: the earlier line wins)
+//   - tokens named "skip" are matched but not printed (whitespace, comments)
+//   - lines starting with "//" and blank lines are ignored
+// Regex syntax: literals, \ escapes (\n \t \r \f \v \s \d \w, anything else literal),
+// . (any byte but newline), [...] classes with ranges and ^, ( ) | * + ?
+//
+// usage: LEXER_GENERATOR spec.txt input.c [--table]
+
+typedef bitset<256> CharSet;
+
+// Syntax tree node
+struct Node {
+    Type type;
+    Node *left, *right, *child;
+    CharSet chars;   // LEAF only
+    int token;       // END only
+    int position;    // LEAF and END
+    bool nullable;
+    PosSet firstpos, lastpos;
+
+    Node(Type t) : type(t), left(nullptr), right(nullptr), child(nullptr), token(-1), position(-1), nullable(false) {}
+};
+
+struct TokenSpec {
+    string name;
+    int priority;
+    string regex;
+};
+
+// ---------- Regex parser ----------
+// Recursive descent: alternation < concatenation < postfix operators < atoms.
+struct RegexParser {
+    const string &re;
+    size_t pos = 0;
+    string error;
+
+    RegexParser(const string &r) : re(r) {}
+
+    bool more() const { return pos < re.size(); }
+    char peek() const { return re[pos]; }
+
+    static Node *leaf(const CharSet &cs) {
+        Node *n = new Node(LEAF);
+        n->chars = cs;
+        return n;
+    }
+    static Node *binary(Type t, Node *l, Node *r) {
+        Node *n = new Node(t);
+        n->left = l;
+        n->right = r;
+        return n;
+    }
+    static Node *star(Node *c) {
+        Node *n = new Node(STAR);
+        n->child = c;
+        return n;
+    }
+    // Deep copy, used to expand x+ into x.x*
+    static Node *clone(Node *n) {
+        if (!n) return nullptr;
+        Node *c = new Node(n->type);
+        c->chars = n->chars;
+        c->left = clone(n->left);
+        c->right = clone(n->right);
+        c->child = clone(n->child);
+        return c;
+    }
+
+    static int firstChar(const CharSet &cs) {
+        for (int c = 0; c < 256; c++)
+            if (cs[c]) return c;
+        return 0;
+    }
+
+    CharSet escapeSet(char e) {
+        CharSet cs;
+        switch (e) {
+        case 'n': cs.set('\n'); break;
+        case 't': cs.set('\t'); break;
+        case 'r': cs.set('\r'); break;
+        case 'f': cs.set('\f'); break;
+        case 'v': cs.set('\v'); break;
+        case 's': for (char c : string(" \t\n\r\f\v")) cs.set((unsigned char)c); break;
+        case 'd': for (int c = '0'; c <= '9'; c++) cs.set(c); break;
+        case 'w':
+            for (int c = 0; c < 256; c++)
+                if (isalnum(c) || c == '_') cs.set(c);
+            break;
+        default: cs.set((unsigned char)e);
+        }
+        return cs;
+    }
+
+    Node *parseClass() {
+        pos++; // '['
+        bool negate = more() && peek() == '^';
+        if (negate) pos++;
+        CharSet cs;
+        bool first = true;
+        while (more() && (peek() != ']' || first)) {
+            first = false;
+            int lo;
+            if (peek() == '\\' && pos + 1 < re.size()) {
+                CharSet item = escapeSet(re[pos + 1]);
+                pos += 2;
+                if (item.count() != 1) { cs |= item; continue; }
+                lo = firstChar(item);
+            } else {
+                lo = (unsigned char)re[pos++];
+            }
+            int hi = lo;
+            if (pos + 1 < re.size() && peek() == '-' && re[pos + 1] != ']') {
+                pos++;
+                if (peek() == '\\' && pos + 1 < re.size()) {
+                    hi = firstChar(escapeSet(re[pos + 1]));
+                    pos += 2;
+                } else {
+                    hi = (unsigned char)re[pos++];
+                }
+            }
+            for (int c = lo; c <= hi; c++) cs.set(c);
+        }
+        if (!more()) { error = "unterminated [ class"; return nullptr; }
+        pos++; // ']'
+        if (negate) cs.flip();
+        return leaf(cs);
+    }
+
+    Node *parseAtom() {
+        char c = peek();
+        if (c == '(') {
+            pos++;
+            Node *n = parseAlt();
+            if (!n) return nullptr;
+            if (!more() || peek() != ')') { error = "missing )"; return nullptr; }
+            pos++;
+            return n;
+        }
+        if (c == '[') return parseClass();
+        if (c == '.') {
+            pos++;
+            CharSet cs;
+            cs.set();
+            cs.reset('\n');
+            return leaf(cs);
+        }
+        if (c == '\\') {
+            if (pos + 1 >= re.size()) { error = "dangling \\"; return nullptr; }
+            pos += 2;
+            return leaf(escapeSet(re[pos - 1]));
+        }
+        if (c == '*' || c == '+' || c == '?' || c == '|' || c == ')') {
+            error = string("unexpected '") + c + "'";
+            return nullptr;
+        }
+        pos++;
+        CharSet cs;
+        cs.set((unsigned char)c);
+        return leaf(cs);
+    }
+
+    Node *parsePostfix() {
+        Node *n = parseAtom();
+        while (n && more() && (peek() == '*' || peek() == '+' || peek() == '?')) {
+            char op = re[pos++];
+            if (op == '*') n = star(n);
+            else if (op == '+') n = binary(CAT, n, star(clone(n)));
+            else n = binary(OR, n, new Node(EMPTY));
+        }
+        return n;
+    }
+
+    Node *parseConcat() {
+        Node *n = nullptr;
+        while (more() && peek() != '|' && peek() != ')') {
+            Node *next = parsePostfix();
+            if (!next) return nullptr;
+            n = n ? binary(CAT, n, next) : next;
+        }
+        return n ? n : new Node(EMPTY);
+    }
+
+    Node *parseAlt() {
+        Node *n = parseConcat();
+        while (n && more() && peek() == '|') {
+            pos++;
+            Node *r = parseConcat();
+            if (!r) return nullptr;
+            n = binary(OR, n, r);
+        }
+        return n;
+    }
+};
+
+// Numbers the LEAF/END positions left to right and collects them
+void number_positions(Node *n, vector<Node *> &leaves) {
+    if (!n) return;
+    if (n->type == LEAF || n->type == END) {
+        n->position = leaves.size();
+        leaves.push_back(n);
+        return;
+    }
+    number_positions(n->left, leaves);
+    number_positions(n->right, leaves);
+    number_positions(n->child, leaves);
+}
+
+// Table-driven DFA over byte classes. trans[state * numClasses + class], -1 = dead.
+struct LexerDFA {
+    int numStates = 0, numClasses = 0;
+    unsigned char classOf[256];
+    vector<int> trans;
+    vector<int> accept; // token index accepted in each state, -1 if none
+};
+
+// Bytes that no leaf can tell apart share one class
+int compute_byte_classes(const vector<Node *> &leaves, unsigned char classOf[256]) {
+    map<vector<bool>, int> ids;
+    for (int c = 0; c < 256; c++) {
+        vector<bool> sig;
+        for (auto *leaf : leaves)
+            if (leaf->type == LEAF) sig.push_back(leaf->chars[c]);
+        auto it = ids.find(sig);
+        if (it == ids.end()) it = ids.insert({sig, (int)ids.size()}).first;
+        classOf[c] = it->second;
+    }
+    return ids.size();
+}
+
+// Picks the token a set of positions accepts: lowest priority, then earliest rule
+int accepted_token(const PosSet &T, const vector<Node *> &leaves, const vector<TokenSpec> &specs) {
+    int best = -1;
+    T.for_each([&](int p) {
+        if (leaves[p]->type != END) return;
+        int k = leaves[p]->token;
+        if (best == -1 || specs[k].priority < specs[best].priority ||
+            (specs[k].priority == specs[best].priority && k < best))
+            best = k;
+    });
+    return best;
+}
+
+// Subset construction over byte classes, one worklist pass as in DFA.cpp
+LexerDFA construct_dfa(Node *root, const vector<Node *> &leaves, const vector<PosSet> &followpos,
+                       const vector<TokenSpec> &specs) {
+    LexerDFA dfa;
+    dfa.numClasses = compute_byte_classes(leaves, dfa.classOf);
+
+    // classesOf[p]: the byte classes leaf position p matches
+    vector<vector<int>> classesOf(leaves.size());
+    for (int c = 0; c < 256; c++) {
+        int cls = dfa.classOf[c];
+        for (auto *leaf : leaves)
+            if (leaf->type == LEAF && leaf->chars[c] &&
+                (classesOf[leaf->position].empty() || classesOf[leaf->position].back() != cls))
+                classesOf[leaf->position].push_back(cls);
+    }
+    for (auto &v : classesOf) {
+        sort(v.begin(), v.end());
+        v.erase(unique(v.begin(), v.end()), v.end());
+    }
+
+    vector<PosSet> states;
+    unordered_map<PosSet, int, PosSetHash> state_ids;
+    states.push_back(root->firstpos);
+    state_ids[root->firstpos] = 0;
+
+    vector<PosSet> move(dfa.numClasses);
+    for (size_t i = 0; i < states.size(); i++) {
+        dfa.accept.push_back(accepted_token(states[i], leaves, specs));
+        for (auto &U : move) U.words.clear();
+        states[i].for_each([&](int p) {
+            for (int cls : classesOf[p]) move[cls].insert(followpos[p]);
+        });
+        for (int cls = 0; cls < dfa.numClasses; cls++) {
+            int target = -1;
+            if (!move[cls].empty()) {
+                auto found = state_ids.emplace(move[cls], (int)states.size());
+                if (found.second) states.push_back(move[cls]);
+                target = found.first->second;
+            }
+            dfa.trans.push_back(target);
+        }
+    }
+    dfa.numStates = states.size();
+    return dfa;
+}
+
+// Hopcroft minimization with the states first grouped by accepted token. The
+// start state stays 0; states that can never accept are dropped (-1).
+LexerDFA minimize_dfa(const LexerDFA &dfa) {
+    int k = dfa.numClasses;
+    vector<vector<int>> trans(dfa.numStates);
+    for (int s = 0; s < dfa.numStates; s++) trans[s].assign(dfa.trans.begin() + s * k, dfa.trans.begin() + (s + 1) * k);
+    MinimizedDFA m = hopcroft_minimize(trans, dfa.accept, 0);
+
+    LexerDFA min;
+    min.numClasses = k;
+    copy(dfa.classOf, dfa.classOf + 256, min.classOf);
+    if (m.start < 0) {
+        // no token can ever match: a start state with no transitions
+        min.numStates = 1;
+        min.trans.assign(k, -1);
+        min.accept.assign(1, -1);
+        return min;
+    }
+    min.numStates = m.size();
+    for (auto &row : m.trans) min.trans.insert(min.trans.end(), row.begin(), row.end());
+    min.accept = m.label;
+    return min;
+}
+
+// Print the transition table, one column per byte class
+void print_table(const LexerDFA &dfa, const vector<TokenSpec> &specs) {
+    cout << "\nByte classes:\n";
+    for (int cls = 0; cls < dfa.numClasses; cls++) {
+        cout << setw(4) << cls << "  ";
+        int shown = 0;
+        for (int c = 0; c < 256 && shown < 16; c++)
+            if (dfa.classOf[c] == cls) {
+                if (isgraph(c)) cout << (char)c;
+                else cout << "\\x" << hex << setw(2) << setfill('0') << c << dec << setfill(' ');
+                shown++;
+            }
+        if (shown == 16) cout << "...";
+        cout << "\n";
+    }
+    cout << "\n" << left << setw(7) << "State";
+    for (int cls = 0; cls < dfa.numClasses; cls++) cout << setw(5) << cls;
+    cout << "Accept\n";
+    for (int s = 0; s < dfa.numStates; s++) {
+        cout << setw(7) << s;
+        for (int cls = 0; cls < dfa.numClasses; cls++) {
+            int t = dfa.trans[s * dfa.numClasses + cls];
+            if (t < 0) cout << setw(5) << "-";
+            else cout << setw(5) << t;
+        }
+        cout << (dfa.accept[s] >= 0 ? specs[dfa.accept[s]].name : "") << "\n";
+    }
+    cout << right;
+}
+
+// Maximal munch: run the DFA as far as it goes, then back up to the last accept
+void scan(const LexerDFA &dfa, const vector<TokenSpec> &specs, const string &text) {
+    size_t pos = 0, n = text.size();
+    int line = 1;
+    const int *trans = dfa.trans.data();
+    const int k = dfa.numClasses;
+
+    while (pos < n) {
+        int state = 0, lastToken = -1;
+        size_t i = pos, lastEnd = pos;
+        while (i < n) {
+            state = trans[state * k + dfa.classOf[(unsigned char)text[i]]];
+            if (state < 0) break;
+            i++;
+            if (dfa.accept[state] >= 0) {
+                lastToken = dfa.accept[state];
+                lastEnd = i;
+            }
+        }
+
+        if (lastToken < 0) {
+            cout << "Lexical Error: Unrecognized symbol '" << text[pos] << "' at line " << line << "\n";
+            if (text[pos] == '\n') line++;
+            pos++;
+            continue;
+        }
+        if (specs[lastToken].name != "skip")
+            cout << specs[lastToken].name << ": " << text.substr(pos, lastEnd - pos) << "\n";
+        line += count(text.begin() + pos, text.begin() + lastEnd, '\n');
+        pos = lastEnd;
+    }
+}
+
+bool read_spec(const string &filename, vector<TokenSpec> &specs) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cout << "Error opening spec file\n";
+        return false;
+    }
+    string line;
+    int lineNo = 0;
+    while (getline(file, line)) {
+        lineNo++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t start = line.find_first_not_of(" \t");
+        if (start == string::npos || line.compare(start, 2, "//") == 0) continue;
+
+        istringstream in(line);
+        TokenSpec spec;
+        if (!(in >> spec.name >> spec.priority)) {
+            cout << "Spec error at line " << lineNo << ": expected NAME PRIORITY REGEX\n";
+            return false;
+        }
+        getline(in, spec.regex);
+        size_t r = spec.regex.find_first_not_of(" \t");
+        spec.regex = (r == string::npos) ? "" : spec.regex.substr(r);
+        if (spec.regex.empty()) {
+            cout << "Spec error at line " << lineNo << ": missing regex\n";
+            return false;
+        }
+        specs.push_back(spec);
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    string specFile, inputFile;
+    bool showTable = false;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--table") showTable = true;
+        else if (specFile.empty()) specFile = arg;
+        else inputFile = arg;
+    }
+    if (specFile.empty()) {
+        cout << "Enter token spec file: ";
+        cin >> specFile;
+    }
+
+    vector<TokenSpec> specs;
+    if (!read_spec(specFile, specs)) return 1;
+    if (specs.empty()) {
+        cout << "Spec file has no tokens\n";
+        return 1;
+    }
+
+    // (r1).#1 | (r2).#2 | ...
+    Node *root = nullptr;
+    for (size_t k = 0; k < specs.size(); k++) {
+        RegexParser parser(specs[k].regex);
+        Node *r = parser.parseAlt();
+        if (r && parser.more()) parser.error = "unexpected ')'";
+        if (!r || !parser.error.empty()) {
+            cout << "Regex error in token " << specs[k].name << ": " << parser.error << "\n";
+            return 1;
+        }
+        Node *end = new Node(END);
+        end->token = k;
+        Node *rule = RegexParser::binary(CAT, r, end);
+        root = root ? RegexParser::binary(OR, root, rule) : rule;
+    }
+
+    vector<Node *> leaves;
+    number_positions(root, leaves);
+    compute_nullable_first_last(root);
+    vector<PosSet> followpos(leaves.size());
+    compute_followpos(root, followpos);
+
+    LexerDFA raw = construct_dfa(root, leaves, followpos, specs);
+    LexerDFA dfa = minimize_dfa(raw);
+
+    cerr << "Tokens: " << specs.size() << ", positions: " << leaves.size()
+         << ", byte classes: " << dfa.numClasses << ", DFA states: " << raw.numStates
+         << " (" << dfa.numStates << " after minimization)\n";
+    if (showTable) print_table(dfa, specs);
+
+    if (inputFile.empty()) {
+        if (showTable) return 0;
+        cout << "Enter file name: ";
+        cin >> inputFile;
+    }
+    ifstream file(inputFile, ios::binary);
+    if (!file.is_open()) {
+        cout << "Error opening file\n";
+        return 1;
+    }
+    stringstream buffer;
+    buffer << file.rdbuf();
+    scan(dfa, specs, buffer.str());
+    return 0;
+}
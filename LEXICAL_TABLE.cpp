@@ -1,200 +1,1878 @@
 #include <bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "TOKEN_STREAM.h"
+#include "SCAN_KERNELS.h"
+#include "OPERATOR_TRIE.h"
+#include "PARALLEL_LEX.h"
+#include "BATCH_LEX.h"
+#include "LEX_TABLES.h"
+#include "XREF_INDEX.h"
+#include "NUMERIC_LITERAL.h"
+#include "LEX_ERRORS.h"
+#include "LEX_STATS.h"
 using namespace std;
 
 // Keywords list
-unordered_set<string> keywords = {"int", "float", "double", "long", "return", "void", "if", "else", "while", "for"};
+constexpr string_view keywordList[] = {"int", "float", "double", "long", "return", "void", "if", "else", "while", "for"};
 
-// Operators
-unordered_set<char> singleOp = {'=', '+', '-', '*', '/', '<', '>', '!', '%'};
-unordered_set<string> multiOp = {"==","!=","<=",">=","++","--","+=","-=","*=","/="};
+// Operators, matched longest first
+constexpr string_view operatorList[] = {
+    "=", "+", "-", "*", "/", "<", ">", "!", "%",
+    "==", "!=", "<=", ">=", "++", "--", "+=", "-=", "*=", "/=", "%=",
+    "<<", ">>", "<<=", ">>=", "->", "&&", "||", "..."
+};
+constexpr OperatorTrie operatorTrie = makeOperatorTrie(operatorList);
 
 // Special Symbols
-unordered_set<char> special = {')','(','{','}',';',','};
+constexpr string_view specialChars = ")({};,";
+
+// ---------- Character classes and keyword hash (LEX_TABLES.h) ----------
+constexpr CharClassTable charClass = makeCharClass(operatorList, specialChars);
+constexpr KeywordTable keywordTable = makeKeywordTable(keywordList);
+
+inline bool hasClass(char c, unsigned char cls) {
+    return charClass.has(c, cls);
+}
+
+// Lexemes are interned once into large blocks; entries only hold views
+struct LexemeArena {
+    vector<unique_ptr<char[]>> blocks;
+    size_t used = 0, capacity = 0;
+
+    string_view intern(string_view s) {
+        if (used + s.size() > capacity) {
+            capacity = max<size_t>(1 << 16, s.size());
+            blocks.emplace_back(new char[capacity]);
+            used = 0;
+        }
+        char *dst = blocks.back().get() + used;
+        memcpy(dst, s.data(), s.size());
+        used += s.size();
+        return string_view(dst, s.size());
+    }
+};
+
+// Line numbers a symbol is used on, in non-decreasing order.
+// Repeats on one line are kept as a run (line, count). Finished runs are
+// varint-encoded into bytes as (delta from the previous run's line) << 1,
+// with the low bit set when a second varint (count - 2) follows. The run
+// still being added to stays unencoded in lastLine / lastCount.
+// Iterating yields every use, repeats included, like the old vector<int>.
+class LinePostings {
+public:
+    void add(int line, uint32_t count = 1) {
+        if (lastCount && line == lastLine) {
+            lastCount += count;
+            return;
+        }
+        flush();
+        lastLine = line;
+        lastCount = count;
+    }
+
+    bool empty() const { return lastCount == 0; }
+    size_t bytesUsed() const { return bytes.capacity(); }
+
+    // fn(line, count) for every run
+    template <class Fn>
+    void forEachRun(Fn &&fn) const {
+        const uint8_t *pos = bytes.data(), *end = pos + bytes.size();
+        int line = 0;
+        while (pos < end) {
+            uint32_t head = getVarint(pos);
+            line += head >> 1;
+            fn(line, (head & 1) ? getVarint(pos) + 2 : 1u);
+        }
+        if (lastCount) fn(lastLine, lastCount);
+    }
+
+    class iterator {
+    public:
+        int operator*() const { return line; }
+        iterator &operator++() {
+            if (--left == 0) loadRun();
+            return *this;
+        }
+        bool operator!=(const iterator &o) const { return pos != o.pos || left != o.left || tailDone != o.tailDone; }
+
+    private:
+        friend class LinePostings;
+        const LinePostings *owner;
+        const uint8_t *pos, *end;
+        int line = 0;
+        uint32_t left = 0;
+        bool tailDone = false;
+
+        iterator(const LinePostings *p, bool atEnd)
+            : owner(p), pos(p->bytes.data() + p->bytes.size()), end(pos) {
+            if (atEnd) {
+                tailDone = true;
+                return;
+            }
+            pos = p->bytes.data();
+            loadRun();
+        }
+        void loadRun() {
+            if (pos < end) {
+                uint32_t head = getVarint(pos);
+                line += head >> 1;
+                left = (head & 1) ? getVarint(pos) + 2 : 1;
+            } else if (!tailDone) {
+                tailDone = true;
+                line = owner->lastLine;
+                left = owner->lastCount;
+            }
+        }
+    };
+    iterator begin() const { return iterator(this, false); }
+    iterator end() const { return iterator(this, true); }
+
+private:
+    vector<uint8_t> bytes;
+    int flushedLine = 0;  // line of the last run in bytes
+    int lastLine = 0;
+    uint32_t lastCount = 0;
+
+    void putVarint(uint32_t v) {
+        while (v >= 0x80) {
+            bytes.push_back((uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        bytes.push_back((uint8_t)v);
+    }
+    static uint32_t getVarint(const uint8_t *&pos) {
+        uint32_t v = 0;
+        for (int shift = 0;; shift += 7) {
+            uint8_t b = *pos++;
+            v |= (uint32_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) return v;
+        }
+    }
+    void flush() {
+        if (!lastCount) return;
+        uint32_t delta = lastLine - flushedLine;
+        putVarint(delta << 1 | (lastCount > 1));
+        if (lastCount > 1) putVarint(lastCount - 2);
+        flushedLine = lastLine;
+    }
+};
 
 // Symbol Table Entry
 struct SymbolEntry {
     int entryNo;
-    string lexeme;
-    string tokenType;
+    string_view lexeme;     // interned in lexemeArena
+    string_view tokenType;  // interned in lexemeArena
     int lineDeclared;
-    vector<int> lineUsed;
+    LinePostings lineUsed;
 };
 
-// Symbol Table
+// Symbol Table (entryNo order)
 vector<SymbolEntry> symbolTable;
+LexemeArena lexemeArena;
+
+// Open-addressing hash index over symbolTable.
+// A slot holds entry index + 1 (0 = empty); the size is always a power of two.
+vector<int> symbolIndex(1024, 0);
+vector<size_t> symbolHash; // hash of each entry, reused when the index grows
+
+size_t hashSymbol(string_view lexeme, string_view type) {
+    size_t h = 14695981039346656037ULL; // FNV-1a
+    for (char ch : lexeme) { h ^= (unsigned char)ch; h *= 1099511628211ULL; }
+    h ^= 0xff; h *= 1099511628211ULL;
+    for (char ch : type) { h ^= (unsigned char)ch; h *= 1099511628211ULL; }
+    return h ^ (h >> 29);
+}
+
+void growSymbolIndex() {
+    vector<int> bigger(symbolIndex.size() * 2, 0);
+    size_t mask = bigger.size() - 1;
+    for (size_t e = 0; e < symbolTable.size(); e++) {
+        size_t slot = symbolHash[e] & mask;
+        while (bigger[slot]) slot = (slot + 1) & mask;
+        bigger[slot] = e + 1;
+    }
+    symbolIndex.swap(bigger);
+}
 
 // Check keyword
-bool isKeyword(string s) {
-    return keywords.find(s) != keywords.end();
+bool isKeyword(string_view s) {
+    return keywordTable.find(s) >= 0;
 }
 
 // Check identifier rules
 bool isIdentifierStart(char c) {
-    return isalpha(c) || c == '_';
+    return hasClass(c, CC_ID_START);
 }
 bool isIdentifierChar(char c) {
-    return isalnum(c) || c == '_';
+    return hasClass(c, CC_ID_CHAR);
 }
 
+// Token classes produced by the lexer
+enum TokenClass { KEYWORD, IDENTIFIER, INTEGER, FLOAT, LITERAL, OPERATOR, SPECIAL, BAD_SYMBOL, UNTERMINATED, BAD_NUMBER };
+
+// A token is a view into the current line (or the mapped file), never a copy
+struct Token {
+    TokenClass cls;
+    string_view text;
+    int line;
+    NumericValue value{};  // decoded INTEGER / FLOAT
+    int column = 0;        // 1-based, set on lexical errors
+};
+
 // Add to symbol table
-void addToSymbolTable(string lexeme, string type, int line) {
-    // check for existing entry
-    for (auto &e : symbolTable) {
-        if (e.lexeme == lexeme && e.tokenType == type) {
-            e.lineUsed.push_back(line);
+void addToSymbolTable(string_view lexeme, string_view type, int line) {
+    // check for existing entry (linear probing)
+    size_t h = hashSymbol(lexeme, type);
+    size_t mask = symbolIndex.size() - 1;
+    size_t slot = h & mask;
+    while (int idx = symbolIndex[slot]) {
+        SymbolEntry &e = symbolTable[idx - 1];
+        if (symbolHash[idx - 1] == h && e.lexeme == lexeme && e.tokenType == type) {
+            e.lineUsed.add(line);
+            LEX_STATS_PROBE((slot - h) & mask);
             return;
         }
+        slot = (slot + 1) & mask;
     }
+    LEX_STATS_PROBE((slot - h) & mask);
     // add new entry
     SymbolEntry newEntry;
     newEntry.entryNo = symbolTable.size() + 1;
-    newEntry.lexeme = lexeme;
-    newEntry.tokenType = type;
+    newEntry.lexeme = lexemeArena.intern(lexeme);
+    newEntry.tokenType = lexemeArena.intern(type);
     newEntry.lineDeclared = line;
-    newEntry.lineUsed.push_back(line);
-    symbolTable.push_back(newEntry);
+    newEntry.lineUsed.add(line);
+    symbolTable.push_back(move(newEntry));
+    symbolHash.push_back(h);
+    symbolIndex[slot] = symbolTable.size();
+    // keep the load factor under 1/2
+    if (symbolTable.size() * 2 > symbolIndex.size()) growSymbolIndex();
 }
 
-// main processing function
-void process(const string &filename) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cout << "Error opening file\n";
-        return;
+// Token type shown in the symbol table; empty for tokens that are not recorded
+string_view symbolTypeName(TokenClass cls) {
+    switch (cls) {
+    case IDENTIFIER: return "Identifier";
+    case INTEGER: return "Integer";
+    case FLOAT: return "Float";
+    case LITERAL: return "Literal";
+    default: return "";
+    }
+}
+
+// ---------- Scoped symbol table (--scoped) ----------
+// Identifiers are bound per block, with '{' / '}' opening and closing scopes.
+// `current` maps each name to its innermost binding, so a lookup is one hash
+// probe. Every declaration also goes on an undo log. Leaving a scope pops only
+// that scope's own entries and puts back the bindings they shadowed.
+struct Binding {
+    string_view name;        // interned in lexemeArena
+    int scope, depth;        // scope number (0 = file scope) and nesting depth
+    int lineDeclared;
+    bool implicit;           // used without a declaration in sight
+    int shadowed;            // binding this one hides, -1 if none
+    LinePostings lineUsed;
+};
+
+class ScopedSymbolTable {
+public:
+    vector<Binding> bindings;  // every binding ever made, in declaration order
+
+    void enterScope() {
+        scopeStart.push_back(undoLog.size());
+        scopeIds.push_back(++scopeCount);
     }
 
-    string line;
-    int lineNo = 0;
-    bool inMultiComment = false;
+    // Drops the innermost scope; O(declarations made in it)
+    void exitScope() {
+        if (scopeStart.empty()) return;
+        for (size_t k = undoLog.size(); k > scopeStart.back(); k--) {
+            const Binding &b = bindings[undoLog[k - 1]];
+            if (b.shadowed >= 0) current[b.name] = b.shadowed;
+            else current.erase(b.name);
+        }
+        undoLog.resize(scopeStart.back());
+        scopeStart.pop_back();
+        scopeIds.pop_back();
+    }
+
+    int depth() const { return scopeStart.size(); }
 
-    while (getline(file, line)) {
-        lineNo++;
-        int i = 0, len = line.length();
+    // Innermost binding of name, or -1
+    int lookup(string_view name) const {
+        auto it = current.find(name);
+        return it == current.end() ? -1 : it->second;
+    }
 
-        while (i < len) {
-            char c = line[i];
+    void declare(string_view name, int line) {
+        int outer = lookup(name);
+        bind(outer >= 0 ? bindings[outer].name : lexemeArena.intern(name), line, false, outer);
+        undoLog.push_back(bindings.size() - 1);
+    }
 
-            // Skip whitespaces
-            if (isspace(c)) { i++; continue; }
+    // A use binds to the innermost declaration; an undeclared name gets an
+    // implicit file-scope binding that is never undone
+    void use(string_view name, int line) {
+        int b = lookup(name);
+        if (b < 0) {
+            bind(lexemeArena.intern(name), line, true, -1);
+            bindings.back().scope = bindings.back().depth = 0;
+            return;
+        }
+        bindings[b].lineUsed.add(line);
+    }
+
+private:
+    unordered_map<string_view, int> current;
+    vector<int> undoLog;        // binding indices, innermost scope last
+    vector<size_t> scopeStart;  // undo log size when each open scope began
+    vector<int> scopeIds;
+    int scopeCount = 0;
+
+    void bind(string_view name, int line, bool implicit, int shadowed) {
+        Binding b{name, scopeIds.empty() ? 0 : scopeIds.back(), depth(), line, implicit, shadowed, {}};
+        b.lineUsed.add(line);
+        bindings.push_back(move(b));
+        current[name] = bindings.size() - 1;
+    }
+};
+
+// Decides from the token stream which identifiers are declarations:
+// identifiers after a type keyword, and after ',' in the same declaration.
+// The parameters of `type name(...)` go into a scope opened at '(' that
+// becomes the body scope when '{' follows and is dropped otherwise.
+// for-loop variables are declared in the enclosing scope.
+class ScopeTracker {
+public:
+    ScopedSymbolTable table;
+
+    void observe(const Token &t) {
+        if (paramsClosed) {
+            paramsClosed = false;
+            if (t.cls == SPECIAL && t.text == "{") {
+                // the parameter scope is the function body
+                parenDepth = 0;
+                inDeclaration = expectName = false;
+                return;
+            }
+            table.exitScope();
+        }
+
+        switch (t.cls) {
+        case KEYWORD:
+            if (isTypeKeyword(t.text)) {
+                if (!inDeclaration) parenDepth = 0;
+                inDeclaration = expectName = true;
+            }
+            break;
+        case IDENTIFIER:
+            if (expectName) {
+                table.declare(t.text, t.line);
+                expectName = false;
+                afterDeclarator = true;
+                return;
+            }
+            table.use(t.text, t.line);
+            break;
+        case SPECIAL:
+            if (t.text == "(") {
+                if (afterDeclarator && parenDepth == 0 && paramDepth < 0) {
+                    table.enterScope();
+                    paramDepth = 1;
+                    afterDeclarator = false;
+                    return;
+                }
+                parenDepth++;
+                if (paramDepth > 0) paramDepth++;
+            } else if (t.text == ")") {
+                if (paramDepth > 0 && --paramDepth == 0) {
+                    paramDepth = -1;
+                    paramsClosed = true;
+                    inDeclaration = expectName = false;
+                } else if (parenDepth > 0) {
+                    parenDepth--;
+                }
+            } else if (t.text == ",") {
+                if (inDeclaration && parenDepth == 0) expectName = true;
+            } else if (t.text == ";") {
+                if (paramDepth < 0) inDeclaration = expectName = false;
+            } else if (t.text == "{") {
+                inDeclaration = expectName = false;
+                table.enterScope();
+            } else if (t.text == "}") {
+                inDeclaration = expectName = false;
+                table.exitScope();
+            }
+            break;
+        default:
+            break;
+        }
+        afterDeclarator = false;
+    }
+
+private:
+    bool inDeclaration = false;    // between a type keyword and the end of its declaration
+    bool expectName = false;       // the next identifier is declared
+    bool afterDeclarator = false;  // the previous token was a declared name
+    bool paramsClosed = false;     // a parameter list just closed
+    int parenDepth = 0;            // '(' nesting inside a declaration
+    int paramDepth = -1;           // '(' nesting inside a parameter list, -1 outside one
+
+    static bool isTypeKeyword(string_view s) {
+        return s == "int" || s == "float" || s == "double" || s == "long" || s == "void";
+    }
+};
+
+bool scopedMode = false;
+ScopeTracker scopeTracker;
+
+void printScopedTable(ostream &out = cout) {
+    out << "\n===== SCOPED SYMBOL TABLE =====\n";
+    out << "Entry\tLexeme\t\tScope\tDepth\tDeclared\tShadows\tUsed Lines\n";
+    auto &bindings = scopeTracker.table.bindings;
+    for (size_t k = 0; k < bindings.size(); k++) {
+        const Binding &b = bindings[k];
+        out << k + 1 << "\t" << b.name << "\t\t" << b.scope << "\t" << b.depth << "\t";
+        if (b.implicit) out << "-";
+        else out << b.lineDeclared;
+        out << "\t\t";
+        if (b.shadowed >= 0) out << b.shadowed + 1;
+        else out << "-";
+        out << "\t";
+        for (int ln : b.lineUsed) out << ln << " ";
+        out << "\n";
+    }
+}
+
+// ---------- Constant pool ----------
+// Numbers arrive decoded; each distinct value (and type) gets one entry,
+// however it was spelled, so 1, 0x1 and 01 share a row.
+struct ConstantEntry {
+    vector<string_view> spellings;  // interned in lexemeArena, first-seen order
+    LinePostings lineUsed;
+};
+
+ConstantPool constantPool;
+vector<ConstantEntry> constantEntries;  // parallel to constantPool
+
+void addConstant(const Token &t, ConstantPool &pool = constantPool, vector<ConstantEntry> &entries = constantEntries,
+                 LexemeArena &arena = lexemeArena) {
+    size_t k = pool.intern(t.value);
+    if (k == entries.size()) entries.emplace_back();
+    ConstantEntry &e = entries[k];
+    if (find(e.spellings.begin(), e.spellings.end(), t.text) == e.spellings.end())
+        e.spellings.push_back(arena.intern(t.text));
+    e.lineUsed.add(t.line);
+}
+
+void printConstantPool(ostream &out = cout, const ConstantPool &pool = constantPool,
+                       const vector<ConstantEntry> &entries = constantEntries) {
+    out << "\n===== CONSTANT POOL =====\n";
+    out << "Entry\tValue\t\tType\t\tSpellings\tUsed Lines\n";
+    for (size_t k = 0; k < entries.size(); k++) {
+        out << k + 1 << "\t" << formatNumericValue(pool[k]) << "\t\t"
+            << numericTypeName(pool[k].type) << "\t\t";
+        for (auto sp : entries[k].spellings) out << sp << " ";
+        out << "\t";
+        for (int ln : entries[k].lineUsed) out << ln << " ";
+        out << "\n";
+    }
+}
+
+// Record identifiers and literals in the symbol table, numbers in the constant pool
+void recordSymbol(const Token &t) {
+    string_view type = symbolTypeName(t.cls);
+    if (t.cls == INTEGER || t.cls == FLOAT) addConstant(t);
+    else if (!type.empty()) addToSymbolTable(t.text, type, t.line);
+    if (scopedMode) scopeTracker.observe(t);
+}
 
-            // Single line comment
-            if (c == '/' && i+1 < len && line[i+1] == '/') break;
+// ---------- Binary token stream (--binary) ----------
+// Kind names, in TokenClass order, written into the stream header
+const vector<string> tokenKindNames = {"Keyword", "Identifier", "Integer", "Float", "Literal", "Operator",
+                                       "Special Symbol", "Unrecognized symbol", "Unterminated string literal",
+                                       "Invalid numeric literal"};
+string binaryPath;                 // empty: tokens are printed as text
+TokenStreamWriter tokenStream;
+const char *tokenStreamBase = nullptr; // start of the mapped file while the stream is open
 
-            // Start of multi-line comment
-            if (c == '/' && i+1 < len && line[i+1] == '*') {
-                inMultiComment = true;
-                i += 2;
+bool openTokenStream(const string &filename, const char *base) {
+    char resolved[PATH_MAX];
+    string source = realpath(filename.c_str(), resolved) ? resolved : filename;
+    if (!tokenStream.open(binaryPath, source, tokenKindNames)) {
+        cout << "Error opening " << binaryPath << "\n";
+        return false;
+    }
+    tokenStreamBase = base;
+    return true;
+}
+
+void printToken(const Token &t) {
+    switch (t.cls) {
+    case KEYWORD:
+        cout << "Keyword: " << t.text << '\n';
+        break;
+    case IDENTIFIER:
+        cout << "Identifier: " << t.text << '\n';
+        break;
+    case INTEGER:
+        cout << "Integer: " << t.text << '\n';
+        break;
+    case FLOAT:
+        cout << "Float: " << t.text << '\n';
+        break;
+    case LITERAL:
+        cout << "Literal: " << t.text << '\n';
+        break;
+    case OPERATOR:
+        cout << "Operator: " << t.text << '\n';
+        break;
+    case SPECIAL:
+        cout << "Special Symbol: " << t.text << '\n';
+        break;
+    case BAD_SYMBOL:
+        cout << "Lexical Error: Unrecognized symbol" << (t.text.size() > 1 ? "s '" : " '") << escapeBytes(t.text)
+             << "' at " << errorPosition(t.line, t.column, t.text.size()) << '\n';
+        break;
+    case UNTERMINATED:
+        cout << "Lexical Error: Unterminated string literal at " << errorPosition(t.line, t.column, 1) << '\n';
+        break;
+    case BAD_NUMBER:
+        cout << "Lexical Error: Invalid numeric literal '" << escapeBytes(t.text) << "' ("
+             << scanNumericLiteral(t.text.data(), t.text.size()).error << ") at "
+             << errorPosition(t.line, t.column, t.text.size()) << '\n';
+        break;
+    }
+}
+
+bool isLexError(TokenClass cls) {
+    return cls == BAD_SYMBOL || cls == UNTERMINATED || cls == BAD_NUMBER;
+}
+
+// Print a token (or append it to the binary stream) and record it in the symbol table.
+// Errors past the error budget are counted, not printed or streamed.
+void emitToken(const Token &t) {
+    LEX_STATS_TOKEN(t.cls);
+    if (tokenStreamBase) {
+        if (!isLexError(t.cls) || errorBudget.report())
+            tokenStream.add(t.cls, t.text.data() - tokenStreamBase, t.text.size(), t.line, t.value.bits);
+    } else if (!isLexError(t.cls)) {
+        printToken(t);
+    } else if (errorBudget.report()) {
+        printToken(t);
+        if (errorBudget.exhausted())
+            cout << "Lexical Error: " << errorBudget.limit << " errors reported; skipping further bad input\n";
+    }
+    recordSymbol(t);
+}
+
+// Whether a token, whitespace or a comment can start at line[i]
+bool startsToken(string_view line, size_t i) {
+    char c = line[i];
+    if (hasClass(c, CC_SPACE | CC_ID_START | CC_DIGIT | CC_SPECIAL) || c == '"') return true;
+    return hasClass(c, CC_OP) && operatorTrie.match(line.data() + i, line.size() - i);
+}
+
+// Lex one line from column `from` on. inMultiComment carries the comment state across lines.
+template <class Emit>
+void lexLine(string_view line, int lineNo, bool &inMultiComment, Emit &&emit, size_t from = 0) {
+    size_t i = from, len = line.length();
+
+    while (i < len) {
+        char c = line[i];
+
+        // Skip whitespaces (runs of them with the vector kernel)
+        if (hasClass(c, CC_SPACE)) {
+            size_t end = i + 1;
+            if (end < len && hasClass(line[end], CC_SPACE)) end = scan.skipSpaces(line.data(), end, len);
+            LEX_STATS_BYTES(whitespace, end - i);
+            i = end;
+            continue;
+        }
+
+        // Single line comment
+        if (c == '/' && i+1 < len && line[i+1] == '/') {
+            LEX_STATS_BYTES(comment, len - i);
+            break;
+        }
+
+        // Start of multi-line comment
+        if (c == '/' && i+1 < len && line[i+1] == '*') {
+            inMultiComment = true;
+            LEX_STATS_BYTES(comment, 2);
+            i += 2;
+            continue;
+        }
+
+        // End of multi-line comment. Inside a comment only '*' and '/' can
+        // change anything, so jump straight to the next one.
+        if (inMultiComment) {
+            size_t end;
+            if (c == '*' && i+1 < len && line[i+1] == '/') {
+                inMultiComment = false;
+                end = i + 2;
+            } else end = scan.findEither(line.data(), i + 1, len, '*', '/');
+            LEX_STATS_BYTES(comment, end - i);
+            i = end;
+            continue;
+        }
+
+        // ✅ STRING LITERAL (the token keeps its quotes)
+        if (c == '"') {
+            size_t start = i++;
+            i = scan.findByte(line.data(), i, len, '"');
+            if (i < len && line[i] == '"') {
+                i++;
+                emit(Token{LITERAL, line.substr(start, i - start), lineNo});
+            } else {
+                emit(Token{UNTERMINATED, line.substr(start, i - start), lineNo, {}, (int)start + 1});
+            }
+            continue;
+        }
+
+        // ✅ IDENTIFIER or KEYWORD
+        if (isIdentifierStart(c)) {
+            size_t start = i;
+            while (i < len && isIdentifierChar(line[i])) i++;
+            string_view token = line.substr(start, i - start);
+            emit(Token{isKeyword(token) ? KEYWORD : IDENTIFIER, token, lineNo});
+            continue;
+        }
+
+        // ✅ NUMBERS (decoded to typed values, see NUMERIC_LITERAL.h)
+        if (hasClass(c, CC_DIGIT)) {
+            NumericLiteral lit = scanNumericLiteral(line.data() + i, len - i);
+            TokenClass cls = lit.error ? BAD_NUMBER : lit.value.isFloating() ? FLOAT : INTEGER;
+            emit(Token{cls, line.substr(i, lit.length), lineNo, lit.value, (int)i + 1});
+            i += lit.length;
+            continue;
+        }
+
+        // ✅ OPERATOR (longest match)
+        if (hasClass(c, CC_OP)) {
+            if (size_t n = operatorTrie.match(line.data() + i, len - i)) {
+                emit(Token{OPERATOR, line.substr(i, n), lineNo});
+                i += n;
                 continue;
             }
+        }
+
+        // ✅ SPECIAL SYMBOL
+        if (hasClass(c, CC_SPECIAL)) {
+            emit(Token{SPECIAL, line.substr(i, 1), lineNo});
+            i++;
+            continue;
+        }
+
+        // ✅ INVALID TOKEN: one error for the whole run of bytes that cannot
+        // start a token. Once the error budget is spent, skip to a resync point.
+        if (activeBudget && activeBudget->exhausted()) {
+            size_t start = i;
+            i = skipToResyncPoint(line.data(), i, len);
+            activeBudget->skipped(i - start);
+            continue;
+        }
+        size_t start = i++;
+        while (i < len && !startsToken(line, i)) i++;
+        emit(Token{BAD_SYMBOL, line.substr(start, i - start), lineNo, {}, (int)start + 1});
+    }
+}
+
+// lexLine() as an object, for the drivers in PARALLEL_LEX.h
+constexpr auto lineLexer = [](string_view line, int lineNo, bool &inMultiComment, auto &&emit, size_t from) {
+    lexLine(line, lineNo, inMultiComment, emit, from);
+};
+
+// ✅ PRINT SYMBOL TABLE
+void printSymbolTable(ostream &out = cout, const vector<SymbolEntry> &table = symbolTable) {
+    out << "\n===== SYMBOL TABLE =====\n";
+    out << "Entry\tLexeme\t\tToken Type\tDeclared\tUsed Lines\n";
+    for (auto &e : table) {
+        out << e.entryNo << "\t" << e.lexeme << "\t\t" << e.tokenType << "\t\t"
+             << e.lineDeclared << "\t\t";
+        for (int ln : e.lineUsed) out << ln << " ";
+        out << endl;
+    }
+}
+
+// ---------- Preprocessor (--preprocess) ----------
+// Runs between the lexer and the output. Directives are obeyed instead of
+// being lexed as bad symbols, macros are expanded, and #include splices in
+// the tokens of the header.
+//
+// Each file is read and lexed once into a PPSource that is kept for the whole
+// run. A header included many times is lexed only the first time; later
+// inclusions replay its cached tokens through the directive and macro logic,
+// because the result depends on the macros defined at that point. A header
+// that has #pragma once, or that is wrapped in an include guard whose macro is
+// already defined, is skipped without a replay.
+//
+// Every token is reported on the main-file line it ends up on. Header tokens
+// carry the line of the outermost #include; macro expansions carry the line
+// of the invocation. The # and ## operators and variadic macros are not
+// supported, and neither is --binary, whose offsets point into one file.
 
-            // End of multi-line comment
-            if (inMultiComment) {
-                if (c == '*' && i+1 < len && line[i+1] == '/') {
-                    inMultiComment = false;
-                    i += 2;
-                } else i++;
+struct PPLine {
+    int line;              // physical line the line starts on
+    bool directive;
+    string_view name;      // directive name ("define", "include", ...)
+    string_view rest;      // raw text after the directive name
+    uint32_t first, last;  // tokens[first, last): the line's tokens or the directive's operands
+};
+
+struct PPSource {
+    string path, text;
+    vector<Token> tokens;  // views into text
+    vector<PPLine> lines;  // only lines with tokens, and directives
+    string_view guard;     // include-guard macro, empty if none
+    bool once = false;     // #pragma once
+    int timesIncluded = 0;
+};
+
+struct PPMacro {
+    bool functionLike = false;
+    bool active = false;  // being expanded; not expanded again inside itself
+    vector<string_view> params;
+    vector<Token> body;
+};
+
+// Tokens waiting to be expanded, kept as a stack with the next token at the
+// back. An item with `ends` set marks the end of a macro's replacement;
+// popping it makes that macro expandable again.
+struct PPItem {
+    Token tok;
+    PPMacro *ends;
+};
+
+bool isPPName(const Token &t) {
+    return t.cls == IDENTIFIER || t.cls == KEYWORD;
+}
+
+bool isPPSpecial(const Token &t, char c) {
+    return t.cls == SPECIAL && t.text.size() == 1 && t.text[0] == c;
+}
+
+// #if expression over macro-expanded tokens. Unknown names evaluate to 0.
+// + - * and << wrap around; division by zero, LLONG_MIN / -1 and shift counts
+// outside 0..63 are errors, but only in operands that are evaluated, so
+// `0 && 1 / 0` is fine.
+struct PPExpression {
+    const vector<Token> &t;
+    size_t pos = 0;
+    bool ok = true;
+    const char *error = nullptr;  // why an evaluated operation failed
+    int unevaluated = 0;          // depth inside skipped && / || / ?: operands
+
+    static long long wrap(unsigned long long v) { return (long long)v; }
+
+    long long arithmeticError(const char *why) {
+        if (!unevaluated) {
+            ok = false;
+            error = why;
+        }
+        return 0;
+    }
+
+    string_view peek() const { return pos < t.size() ? t[pos].text : string_view(); }
+    bool accept(string_view s) {
+        if (pos >= t.size() || t[pos].text != s) return false;
+        pos++;
+        return true;
+    }
+
+    static int precedence(string_view op) {
+        static const pair<string_view, int> table[] = {
+            {"*", 10}, {"/", 10}, {"%", 10}, {"+", 9}, {"-", 9}, {"<<", 8}, {">>", 8},
+            {"<", 7}, {"<=", 7}, {">", 7}, {">=", 7}, {"==", 6}, {"!=", 6},
+            {"&", 5}, {"^", 4}, {"|", 3}, {"&&", 2}, {"||", 1}};
+        for (auto &[name, prec] : table)
+            if (name == op) return prec;
+        return 0;
+    }
+
+    long long primary() {
+        if (accept("(")) {
+            long long v = conditional();
+            if (!accept(")")) ok = false;
+            return v;
+        }
+        if (accept("!")) return !primary();
+        if (accept("-")) return wrap(0ull - primary());
+        if (accept("+")) return primary();
+        if (accept("~")) return ~primary();
+        if (pos < t.size() && t[pos].cls == INTEGER) return t[pos++].value.integer();
+        if (pos < t.size() && isPPName(t[pos])) {
+            pos++;
+            return 0;
+        }
+        ok = false;
+        return 0;
+    }
+
+    long long binary(int minPrecedence) {
+        long long lhs = primary();
+        while (ok) {
+            string_view op = peek();
+            int prec = precedence(op);
+            if (!prec || prec < minPrecedence) break;
+            pos++;
+            bool skipped = (op == "&&" && !lhs) || (op == "||" && lhs);
+            unevaluated += skipped;
+            long long rhs = binary(prec + 1);
+            unevaluated -= skipped;
+            if ((op == "/" || op == "%") && (rhs == 0 || (rhs == -1 && lhs == LLONG_MIN))) {
+                lhs = arithmeticError(rhs == 0 ? "division by zero" : "division overflow");
+                continue;
+            }
+            if ((op == "<<" || op == ">>") && (rhs < 0 || rhs >= 64)) {
+                lhs = arithmeticError("shift count out of range");
                 continue;
             }
+            if (op == "*") lhs = wrap((unsigned long long)lhs * rhs);
+            else if (op == "/") lhs /= rhs;
+            else if (op == "%") lhs %= rhs;
+            else if (op == "+") lhs = wrap((unsigned long long)lhs + rhs);
+            else if (op == "-") lhs = wrap((unsigned long long)lhs - rhs);
+            else if (op == "<<") lhs = wrap((unsigned long long)lhs << rhs);
+            else if (op == ">>") lhs >>= rhs;
+            else if (op == "<") lhs = lhs < rhs;
+            else if (op == "<=") lhs = lhs <= rhs;
+            else if (op == ">") lhs = lhs > rhs;
+            else if (op == ">=") lhs = lhs >= rhs;
+            else if (op == "==") lhs = lhs == rhs;
+            else if (op == "!=") lhs = lhs != rhs;
+            else if (op == "&") lhs &= rhs;
+            else if (op == "^") lhs ^= rhs;
+            else if (op == "|") lhs |= rhs;
+            else if (op == "&&") lhs = lhs && rhs;
+            else lhs = lhs || rhs;
+        }
+        return lhs;
+    }
 
-            // ✅ STRING LITERAL
-            if (c == '"') {
-                string literal = "";
-                i++; 
-                while (i < len && line[i] != '"') {
-                    literal += line[i++];
-                }
-                if (i < len && line[i] == '"') {
-                    i++;
-                    cout << "Literal: \"" << literal << "\"\n";
-                    addToSymbolTable("\"" + literal + "\"", "Literal", lineNo);
-                } else {
-                    cout << "Lexical Error: Unterminated string literal at line " << lineNo << endl;
-                }
+    long long conditional() {
+        long long c = binary(1);
+        if (!accept("?")) return c;
+        unevaluated += !c;
+        long long a = conditional();
+        unevaluated -= !c;
+        if (!accept(":")) ok = false;
+        unevaluated += c != 0;
+        long long b = conditional();
+        unevaluated -= c != 0;
+        return c ? a : b;
+    }
+};
+
+class Preprocessor {
+public:
+    vector<string> includeDirs;  // searched for <...>, and for "..." after the includer's directory
+
+    // Preprocesses filename and passes every resulting token to emit; false if it cannot be read
+    bool run(const string &filename, function<void(const Token &)> emitFn) {
+        emit = move(emitFn);
+        PPSource *main = load(filename);
+        if (!main) return false;
+        processSource(*main, 0);
+        cerr << "Preprocessed " << filename << ": " << filesLexed << " files lexed, " << includes
+             << " #includes (" << replays << " replayed from the cache, " << skips
+             << " skipped by include guard or #pragma once)\n";
+        return true;
+    }
+
+private:
+    function<void(const Token &)> emit;
+    unordered_map<string, unique_ptr<PPSource>> sources;  // by canonical path; null if unreadable
+    unordered_map<string_view, PPMacro> macros;
+    int includeDepth = 0;
+    size_t filesLexed = 0, includes = 0, replays = 0, skips = 0;
+
+    struct Conditional {
+        bool parentActive, active, taken;
+    };
+
+    static const int MAX_INCLUDE_DEPTH = 200;
+
+    void report(int line, const string &msg) {
+        cout << "Preprocessor Error: " << msg << " at line " << line << '\n';
+    }
+
+    PPMacro *findMacro(const Token &t) {
+        if (macros.empty() || !isPPName(t)) return nullptr;
+        auto it = macros.find(t.text);
+        return it == macros.end() ? nullptr : &it->second;
+    }
+
+    PPSource *load(const string &path) {
+        error_code ec;
+        string key = filesystem::weakly_canonical(path, ec).string();
+        if (ec) key = path;
+        auto it = sources.find(key);
+        if (it != sources.end()) return it->second.get();
+
+        unique_ptr<PPSource> src;
+        ifstream in(path, ios::binary);
+        if (in) {
+            src = make_unique<PPSource>();
+            src->path = key;
+            src->text.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+            lexSource(*src);
+            filesLexed++;
+        }
+        return (sources[key] = move(src)).get();
+    }
+
+    // Lex a whole file into lines once. A directive keeps its raw text and
+    // its operand tokens, and runs on over lines ending in a backslash.
+    static void lexSource(PPSource &src) {
+        string_view text = src.text;
+        auto add = [&](const Token &t) { src.tokens.push_back(t); };
+        // The C lexer has no tokens for & | ^ ~ ? :, so in #if / #elif lines
+        // their bad-symbol runs are split into one-character operators
+        auto addExpression = [&](const Token &t) {
+            if (t.cls != BAD_SYMBOL || t.text.find_first_not_of("&|^~?:") != string_view::npos) return add(t);
+            for (size_t k = 0; k < t.text.size(); k++) add(Token{OPERATOR, t.text.substr(k, 1), t.line});
+        };
+        bool inMultiComment = false;
+        int lineNo = 0;
+        size_t pos = 0;
+        int open = -1;  // directive continued on the next line
+        while (pos < text.size()) {
+            size_t eol = text.find('\n', pos);
+            if (eol == string_view::npos) eol = text.size();
+            string_view line = text.substr(pos, eol - pos);
+            pos = eol + 1;
+            lineNo++;
+
+            size_t i = 0;
+            while (i < line.size() && hasClass(line[i], CC_SPACE)) i++;
+            if (open < 0 && (inMultiComment || i == line.size() || line[i] != '#')) {
+                size_t first = src.tokens.size();
+                lexLine(line, lineNo, inMultiComment, add);
+                if (src.tokens.size() > first)
+                    src.lines.push_back(PPLine{lineNo, false, {}, {}, (uint32_t)first, (uint32_t)src.tokens.size()});
                 continue;
             }
 
-            // ✅ IDENTIFIER or KEYWORD
-            if (isIdentifierStart(c)) {
-                string token = "";
-                while (i < len && isIdentifierChar(line[i])) {
-                    token += line[i++];
-                }
-                if (isKeyword(token)) {
-                    cout << "Keyword: " << token << endl;
-                } else {
-                    cout << "Identifier: " << token << endl;
-                    addToSymbolTable(token, "Identifier", lineNo);
+            size_t end = line.size();
+            while (end > 0 && hasClass(line[end - 1], CC_SPACE)) end--;
+            bool continued = end > 0 && line[end - 1] == '\\';
+            if (continued) line = line.substr(0, end - 1);
+            if (open < 0) {
+                i++;
+                while (i < line.size() && hasClass(line[i], CC_SPACE)) i++;
+                size_t n = i;
+                while (n < line.size() && isIdentifierChar(line[n])) n++;
+                src.lines.push_back(PPLine{lineNo, true, line.substr(i, n - i), line.substr(n),
+                                           (uint32_t)src.tokens.size(), 0});
+                open = src.lines.size() - 1;
+                i = n;
+            } else {
+                i = 0;
+            }
+            string_view name = src.lines[open].name;
+            if (name == "if" || name == "elif") lexLine(line, lineNo, inMultiComment, addExpression, i);
+            else lexLine(line, lineNo, inMultiComment, add, i);
+            src.lines[open].last = src.tokens.size();
+            if (!continued) open = -1;
+        }
+        findGuard(src);
+    }
+
+    // #ifndef G / #define G ... #endif around everything else in the file
+    static void findGuard(PPSource &src) {
+        auto &lines = src.lines;
+        auto operand = [&](const PPLine &l) { return l.first < l.last ? src.tokens[l.first].text : string_view(); };
+        if (lines.size() < 3 || !lines[0].directive || lines[0].name != "ifndef") return;
+        string_view guard = operand(lines[0]);
+        if (guard.empty() || !lines[1].directive || lines[1].name != "define" || operand(lines[1]) != guard) return;
+        int depth = 0;
+        for (size_t k = 0; k < lines.size(); k++) {
+            if (!lines[k].directive) continue;
+            string_view d = lines[k].name;
+            if (d == "if" || d == "ifdef" || d == "ifndef") depth++;
+            else if (d == "endif" && --depth == 0) {
+                if (k + 1 == lines.size()) src.guard = guard;
+                return;
+            }
+        }
+    }
+
+    // True if the tokens end inside the argument list of a function-like
+    // macro (or with its name), so the invocation continues on the next line
+    bool endsInsideCall(const vector<Token> &ts) {
+        int depth = 0;
+        bool inCall = false;
+        for (size_t i = 0; i < ts.size(); i++) {
+            if (!inCall) {
+                PPMacro *m = findMacro(ts[i]);
+                if (m && m->functionLike) {
+                    if (i + 1 == ts.size()) return true;
+                    if (isPPSpecial(ts[i + 1], '(')) inCall = true, depth = 0;
                 }
                 continue;
             }
+            if (isPPSpecial(ts[i], '(')) depth++;
+            else if (isPPSpecial(ts[i], ')') && --depth == 0) inCall = false;
+        }
+        return inCall;
+    }
 
-            // ✅ NUMBERS
-            if (isdigit(c)) {
-                string number = "";
-                bool isFloat = false;
+    // Expands macros in input and appends the result to out. Replacements
+    // are pushed back onto the input and rescanned with their own macro
+    // disabled; arguments are expanded before they are substituted.
+    void expand(const vector<Token> &input, vector<Token> &out) {
+        vector<PPItem> work;
+        for (size_t k = input.size(); k-- > 0;) work.push_back(PPItem{input[k], nullptr});
+        auto pop = [&]() {
+            // markers are consumed as they surface
+            while (!work.empty() && work.back().ends) {
+                work.back().ends->active = false;
+                work.pop_back();
+            }
+        };
 
-                while (i < len && (isdigit(line[i]) || line[i] == '.')) {
-                    if (line[i] == '.') {
-                        if (isFloat) break;
-                        isFloat = true;
+        while (true) {
+            pop();
+            if (work.empty()) break;
+            Token t = work.back().tok;
+            work.pop_back();
+            PPMacro *m = findMacro(t);
+            if (!m || m->active) {
+                out.push_back(t);
+                continue;
+            }
+
+            vector<vector<Token>> args;
+            if (m->functionLike) {
+                pop();
+                if (work.empty() || !isPPSpecial(work.back().tok, '(')) {
+                    out.push_back(t);
+                    continue;
+                }
+                vector<Token> consumed{work.back().tok};
+                work.pop_back();
+                args.emplace_back();
+                int depth = 0;
+                bool closed = false;
+                while (pop(), !work.empty()) {
+                    Token a = work.back().tok;
+                    work.pop_back();
+                    consumed.push_back(a);
+                    if (isPPSpecial(a, ')') && depth == 0) {
+                        closed = true;
+                        break;
                     }
-                    number += line[i++];
+                    if (isPPSpecial(a, '(')) depth++;
+                    else if (isPPSpecial(a, ')')) depth--;
+                    else if (isPPSpecial(a, ',') && depth == 0) {
+                        args.emplace_back();
+                        continue;
+                    }
+                    args.back().push_back(a);
                 }
-                if (isFloat) {
-                    cout << "Float: " << number << endl;
-                    addToSymbolTable(number, "Float", lineNo);
-                } else {
-                    cout << "Integer: " << number << endl;
-                    addToSymbolTable(number, "Integer", lineNo);
+                if (args.size() == 1 && args[0].empty() && m->params.empty()) args.clear();
+                if (!closed || args.size() != m->params.size()) {
+                    if (!closed) report(t.line, "unterminated call to macro " + string(t.text));
+                    else report(t.line, "macro " + string(t.text) + " expects " + to_string(m->params.size()) +
+                                            " arguments, got " + to_string(args.size()));
+                    out.push_back(t);
+                    out.insert(out.end(), consumed.begin(), consumed.end());
+                    continue;
+                }
+                for (auto &arg : args) {
+                    vector<Token> expanded;
+                    expand(arg, expanded);
+                    arg.swap(expanded);
                 }
-                continue;
             }
 
-            // ✅ MULTICHAR OPERATOR
-            if (i+1 < len) {
-                string op = string(1, c) + line[i+1];
-                if (multiOp.find(op) != multiOp.end()) {
-                    cout << "Operator: " << op << endl;
-                    i += 2;
+            vector<Token> replacement;
+            for (Token b : m->body) {
+                auto param = find(m->params.begin(), m->params.end(), b.text);
+                if (isPPName(b) && param != m->params.end()) {
+                    for (Token a : args[param - m->params.begin()]) {
+                        a.line = t.line;
+                        replacement.push_back(a);
+                    }
                     continue;
                 }
+                b.line = t.line;
+                replacement.push_back(b);
             }
+            m->active = true;
+            work.push_back(PPItem{t, m});
+            for (size_t k = replacement.size(); k-- > 0;) work.push_back(PPItem{replacement[k], nullptr});
+        }
+    }
 
-            // ✅ SINGLE OPERATOR
-            if (singleOp.find(c) != singleOp.end()) {
-                cout << "Operator: " << c << endl;
-                i++;
+    bool evaluate(const Token *first, const Token *last, int line) {
+        static const string_view one = "1", zero = "0";
+        vector<Token> in;
+        for (const Token *p = first; p < last; p++) {
+            if (p->text != "defined") {
+                in.push_back(*p);
                 continue;
             }
+            bool paren = p + 1 < last && isPPSpecial(p[1], '(');
+            const Token *name = p + 1 + paren;
+            if (name >= last || !isPPName(*name) || (paren && (name + 1 >= last || !isPPSpecial(name[1], ')')))) {
+                report(line, "invalid use of defined");
+                return false;
+            }
+            bool defined = macros.count(name->text);
+            in.push_back(Token{INTEGER, defined ? one : zero, line, NumericValue{NumericType::Int, defined}});
+            p = name + paren;
+        }
+        vector<Token> expanded;
+        expand(in, expanded);
+        PPExpression e{expanded};
+        long long v = e.conditional();
+        if (!e.ok || e.pos != expanded.size()) {
+            report(line, e.error ? string(e.error) + " in #if expression" : "invalid #if expression");
+            return false;
+        }
+        return v != 0;
+    }
 
-            // ✅ SPECIAL SYMBOL
-            if (special.find(c) != special.end()) {
-                cout << "Special Symbol: " << c << endl;
-                i++;
+    void define(const PPLine &d, int line, const PPSource &src) {
+        const Token *op = src.tokens.data() + d.first, *end = src.tokens.data() + d.last;
+        if (op == end || !isPPName(*op)) {
+            report(line, "macro name missing");
+            return;
+        }
+        PPMacro m;
+        string_view name = op++->text;
+        // function-like only when '(' touches the name
+        if (op < end && isPPSpecial(*op, '(') && op->text.data() == name.data() + name.size()) {
+            op++;
+            while (op < end && !isPPSpecial(*op, ')')) {
+                if (!isPPName(*op)) {
+                    report(line, "bad parameter list for macro " + string(name));
+                    return;
+                }
+                m.params.push_back(op++->text);
+                if (op < end && isPPSpecial(*op, ',')) op++;
+            }
+            if (op == end) {
+                report(line, "missing ')' in macro " + string(name));
+                return;
+            }
+            op++;
+            m.functionLike = true;
+        }
+        m.body.assign(op, end);
+        macros[name] = move(m);
+    }
+
+    void include(const PPLine &d, int line, const PPSource &from) {
+        string_view r = d.rest;
+        size_t b = 0;
+        while (b < r.size() && hasClass(r[b], CC_SPACE)) b++;
+        char close = b < r.size() && r[b] == '"' ? '"' : b < r.size() && r[b] == '<' ? '>' : 0;
+        size_t e = close ? r.find(close, b + 1) : string_view::npos;
+        if (e == string_view::npos) {
+            report(line, "#include expects \"FILE\" or <FILE>");
+            return;
+        }
+        string target(r.substr(b + 1, e - b - 1));
+
+        PPSource *src = nullptr;
+        if (close == '"') src = load((filesystem::path(from.path).parent_path() / target).string());
+        for (size_t k = 0; !src && k < includeDirs.size(); k++)
+            src = load((filesystem::path(includeDirs[k]) / target).string());
+        if (!src) {
+            // system headers are not on the search path unless given with -I
+            if (close == '"') report(line, "cannot open include file \"" + target + "\"");
+            return;
+        }
+        includes++;
+        if ((src->once && src->timesIncluded) || (!src->guard.empty() && macros.count(src->guard))) {
+            skips++;
+            return;
+        }
+        if (includeDepth == MAX_INCLUDE_DEPTH) {
+            report(line, "#include nested too deeply");
+            return;
+        }
+        if (src->timesIncluded) replays++;
+        includeDepth++;
+        processSource(*src, line);
+        includeDepth--;
+    }
+
+    // site: main-file line of the outermost #include, 0 for the main file itself
+    void processSource(PPSource &src, int site) {
+        src.timesIncluded++;
+        vector<Conditional> conds;
+        auto live = [&] { return conds.empty() || conds.back().active; };
+        vector<Token> text, out;
+
+        for (size_t k = 0; k < src.lines.size(); k++) {
+            const PPLine &l = src.lines[k];
+            int line = site ? site : l.line;
+            if (!l.directive) {
+                if (!live()) continue;
+                text.assign(src.tokens.begin() + l.first, src.tokens.begin() + l.last);
+                while (endsInsideCall(text) && k + 1 < src.lines.size() && !src.lines[k + 1].directive) {
+                    const PPLine &next = src.lines[++k];
+                    text.insert(text.end(), src.tokens.begin() + next.first, src.tokens.begin() + next.last);
+                }
+                if (site)
+                    for (auto &t : text) t.line = site;
+                out.clear();
+                expand(text, out);
+                for (auto &t : out) emit(t);
                 continue;
             }
 
-            // ✅ INVALID TOKEN
-            cout << "Lexical Error: Unrecognized symbol '" << c << "' at line " << lineNo << endl;
-            i++;
+            string_view d = l.name;
+            const Token *op = src.tokens.data() + l.first, *end = src.tokens.data() + l.last;
+            if (d == "ifdef" || d == "ifndef") {
+                bool defined = op < end && macros.count(op->text);
+                bool active = live() && defined == (d == "ifdef");
+                conds.push_back(Conditional{live(), active, active});
+            } else if (d == "if") {
+                bool active = live() && evaluate(op, end, line);
+                conds.push_back(Conditional{live(), active, active});
+            } else if (d == "elif" || d == "else") {
+                if (conds.empty()) {
+                    report(line, "#" + string(d) + " without #if");
+                    continue;
+                }
+                Conditional &c = conds.back();
+                c.active = c.parentActive && !c.taken && (d == "else" || evaluate(op, end, line));
+                c.taken |= c.active;
+            } else if (d == "endif") {
+                if (conds.empty()) report(line, "#endif without #if");
+                else conds.pop_back();
+            } else if (!live()) {
+                continue;
+            } else if (d == "define") {
+                define(l, line, src);
+            } else if (d == "undef") {
+                if (op < end) macros.erase(op->text);
+            } else if (d == "include") {
+                include(l, line, src);
+            } else if (d == "pragma") {
+                if (op < end && op->text == "once") src.once = true;
+            } else if (d == "error") {
+                report(line, "#error" + string(l.rest));
+            } else if (!d.empty() && d != "line" && d != "warning") {
+                report(line, "unknown directive #" + string(d));
+            }
+        }
+        if (!conds.empty()) report(site ? site : src.lines.back().line, "unterminated #if in " + src.path);
+    }
+};
+
+bool preprocessMode = false;
+vector<string> includeDirs;
+
+// main processing function
+void process(const string &filename) {
+    if (preprocessMode) {
+        LEX_STATS_PHASE("preprocess");
+        Preprocessor preprocessor;
+        preprocessor.includeDirs = includeDirs;
+        if (!preprocessor.run(filename, emitToken)) {
+            cout << "Error opening file\n";
+            return;
+        }
+    } else {
+        LEX_STATS_PHASE("lex");
+        ifstream file(filename);
+        if (!file.is_open()) {
+            cout << "Error opening file\n";
+            return;
+        }
+
+        string line;
+        int lineNo = 0;
+        bool inMultiComment = false;
+
+        while (getline(file, line)) {
+            lineNo++;
+            lexLine(line, lineNo, inMultiComment, emitToken);
         }
+
+        file.close();
     }
 
-    file.close();
+    LEX_STATS_PHASE("tables");
+    printErrorSummary(cout, "Lexical Error: ");
+    printSymbolTable();
+    printConstantPool();
+    if (scopedMode) printScopedTable();
+}
+
+// ---------- Cross-reference index (--index) ----------
+string indexPath;
+
+void saveIndex(XrefIndexWriter &index) {
+    LEX_STATS_PHASE("index");
+    if (!index.write(indexPath)) cerr << "Cannot write index " << indexPath << "\n";
+}
+
+void addPostings(XrefIndexWriter &index, uint32_t file, const LinePostings &lines) {
+    lines.forEachRun([&](int line, uint32_t count) {
+        while (count--) index.addPosting(file, line);
+    });
+}
+
+// A pooled constant is indexed under its value, with its C type as the token type
+void beginConstant(XrefIndexWriter &index, const NumericValue &v) {
+    index.beginSymbol(formatNumericValue(v), numericTypeName(v.type));
+}
 
-    // ✅ PRINT SYMBOL TABLE
-    cout << "\n===== SYMBOL TABLE =====\n";
-    cout << "Entry\tLexeme\t\tToken Type\tDeclared\tUsed Lines\n";
+// The single-file symbol table and constant pool as an index with one file
+void writeSymbolIndex(const string &filename) {
+    XrefIndexWriter index;
+    uint32_t file = index.addFile(filename);
     for (auto &e : symbolTable) {
+        index.beginSymbol(e.lexeme, e.tokenType);
+        addPostings(index, file, e.lineUsed);
+    }
+    for (size_t k = 0; k < constantEntries.size(); k++) {
+        beginConstant(index, constantPool[k]);
+        addPostings(index, file, constantEntries[k].lineUsed);
+    }
+    saveIndex(index);
+}
+
+// Close the token stream, if any, and print the symbol table.
+// With the stream on stdout the table goes to stderr.
+void finishOutput() {
+    LEX_STATS_PHASE("tables");
+    if (tokenStreamBase) {
+        tokenStream.close();
+        tokenStreamBase = nullptr;
+    }
+    printErrorSummary(binaryPath == "-" ? cerr : cout, "Lexical Error: ");
+    printSymbolTable(binaryPath == "-" ? cerr : cout);
+    printConstantPool(binaryPath == "-" ? cerr : cout);
+    if (scopedMode) printScopedTable(binaryPath == "-" ? cerr : cout);
+}
+
+// Same as process(), but maps the file and lexes straight out of the mapping.
+// Lines and tokens are views into the mapping, so nothing is copied per token.
+void processMapped(const string &filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        cout << "Error opening file\n";
+        return;
+    }
+
+    string_view text = file.view();
+    if (!binaryPath.empty() && !openTokenStream(filename, text.data())) return;
+    lexLines(text, 0, 1, 0, lineLexer, emitToken);
+    finishOutput();
+}
+
+// ---------- Parallel mode ----------
+// Lex the file in chunks on nThreads threads, then stitch the chunks together
+// in file order (see PARALLEL_LEX.h). Output is identical to process().
+void processParallel(const string &filename, int nThreads) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        cout << "Error opening file\n";
+        return;
+    }
+
+    string_view text = file.view();
+    if (!binaryPath.empty() && !openTokenStream(filename, text.data())) return;
+    lexParallel<Token>(text, nThreads, lineLexer, emitToken);
+    finishOutput();
+}
+
+// ---------- Incremental re-lexing ----------
+// Keeps the token stream of a buffer per line, together with the comment state
+// each line starts and ends in. An edit re-lexes the lines it touches and then
+// keeps going only while the state leaving a line differs from the state the
+// next line was lexed with; after that the old tokens are still valid.
+//
+// Symbol usages are counted per line (by a stable line id, so inserting lines
+// does not renumber them). Lexing or dropping a line adds or subtracts its own
+// usages only; symbolTable() and constants() turn the counts into the usual
+// symbol table and constant pool.
+class IncrementalLexer {
+public:
+    struct LineToken {
+        TokenClass cls;
+        uint32_t start, length; // relative to the start of the line
+    };
+
+    void reset(string_view content) {
+        text.assign(content.data(), content.size());
+        lines.clear();
+        lineStart.clear();
+        lineNumberOfId.clear();
+        symbols.clear();
+        insertLines(0, 0, text.size());
+        relex(0, lines.size());
+    }
+
+    // Replace text[from, to) with replacement. Returns the number of lines re-lexed.
+    int edit(size_t from, size_t to, string_view replacement) {
+        to = min(to, text.size());
+        from = min(from, to);
+        size_t first = lineOf(from), last = lineOf(to);
+        size_t oldEnd = lineEnd(last);
+        long delta = (long)replacement.size() - (long)(to - from);
+
+        // drop the touched lines while their old text is still there, then
+        // split the new text into lines again
+        for (size_t k = first; k <= last; k++) dropSymbols(lines[k]);
+        text.replace(from, to - from, replacement.data(), replacement.size());
+
+        size_t spanStart = lineStart[first];
+        lines.erase(lines.begin() + first, lines.begin() + last + 1);
+        lineStart.erase(lineStart.begin() + first, lineStart.begin() + last + 1);
+        for (size_t k = first; k < lineStart.size(); k++) lineStart[k] += delta;
+        size_t added = insertLines(first, spanStart, oldEnd + delta);
+
+        return relex(first, first + added);
+    }
+
+    const string &buffer() const { return text; }
+    size_t lineCount() const { return lines.size(); }
+
+    // Calls fn(Token) for every token in order, with 1-based line numbers
+    template <class Fn>
+    void forEachToken(Fn &&fn) const {
+        for (size_t k = 0; k < lines.size(); k++)
+            for (auto &t : lines[k].tokens)
+                fn(Token{t.cls, string_view(text).substr(lineStart[k] + t.start, t.length), (int)k + 1, {},
+                         (int)t.start + 1});
+    }
+
+    // The symbol table a full lex of the buffer would build. Numbers are left
+    // to constants(), as process() leaves them to the constant pool.
+    vector<SymbolEntry> symbolTable() const {
+        vector<SymbolEntry> table;
+        for (auto &r : firstUses(false)) {
+            SymbolEntry e;
+            e.entryNo = table.size() + 1;
+            e.lexeme = r.sym->lexeme;
+            e.tokenType = r.sym->type;
+            e.lineDeclared = r.line;
+            addRuns({r.sym}, e.lineUsed);
+            table.push_back(move(e));
+        }
+        return table;
+    }
+
+    // The constant pool a full lex of the buffer would build: one entry per
+    // value, spellings in first-seen order. The spellings point into the lexer
+    // and stay valid until the next edit.
+    void constants(ConstantPool &pool, vector<ConstantEntry> &entries) const {
+        for (auto &r : firstUses(true)) {
+            size_t k = pool.intern(r.sym->value);
+            if (k == entries.size()) entries.emplace_back();
+            entries[k].spellings.push_back(r.sym->lexeme);
+        }
+        // a value's lines come from all of its spellings, merged in line order
+        vector<vector<const Symbol *>> spelledAs(entries.size());
+        for (auto &kv : symbols)
+            if (kv.second.constant) spelledAs[pool.intern(kv.second.value)].push_back(&kv.second);
+        for (size_t k = 0; k < entries.size(); k++) addRuns(spelledAs[k], entries[k].lineUsed);
+    }
+
+private:
+    struct Line {
+        int id;
+        bool entryState = false, exitState = false;
+        vector<LineToken> tokens;
+    };
+    struct Usage {
+        int count = 0;
+        int firstColumn = INT_MAX;
+    };
+    struct Symbol {
+        string lexeme;
+        string_view type;
+        bool constant = false; // a number, kept for the constant pool
+        NumericValue value{};  // decoded, when constant
+        unordered_map<int, Usage> uses; // line id -> usages on that line
+    };
+    struct FirstUse {
+        int line, column;
+        const Symbol *sym;
+    };
+
+    string text;
+    vector<Line> lines;
+    vector<size_t> lineStart;
+    vector<int> lineNumberOfId;
+    unordered_map<string, Symbol> symbols; // key: type + '\0' + lexeme
+
+    // Symbols (or numbers) ordered by where they first occur in the buffer
+    vector<FirstUse> firstUses(bool constant) const {
+        vector<FirstUse> rows;
+        for (auto &kv : symbols) {
+            if (kv.second.constant != constant) continue;
+            FirstUse r{INT_MAX, INT_MAX, &kv.second};
+            for (auto &use : kv.second.uses) {
+                int ln = lineNumberOfId[use.first];
+                if (ln < r.line || (ln == r.line && use.second.firstColumn < r.column)) {
+                    r.line = ln;
+                    r.column = use.second.firstColumn;
+                }
+            }
+            rows.push_back(r);
+        }
+        sort(rows.begin(), rows.end(), [](const FirstUse &a, const FirstUse &b) {
+            return a.line != b.line ? a.line < b.line : a.column < b.column;
+        });
+        return rows;
+    }
+
+    // The usages of syms, in line order
+    void addRuns(const vector<const Symbol *> &syms, LinePostings &lineUsed) const {
+        vector<pair<int, int>> runs;
+        for (const Symbol *sym : syms)
+            for (auto &use : sym->uses) runs.push_back({lineNumberOfId[use.first], use.second.count});
+        sort(runs.begin(), runs.end());
+        for (auto &run : runs) lineUsed.add(run.first, run.second);
+    }
+
+    size_t lineOf(size_t pos) const {
+        return upper_bound(lineStart.begin(), lineStart.end(), pos) - lineStart.begin() - 1;
+    }
+    size_t lineEnd(size_t k) const {
+        return k + 1 < lineStart.size() ? lineStart[k + 1] - 1 : text.size();
+    }
+
+    // Split text[from, to) into lines inserted at index k. The text always has
+    // (number of '\n' + 1) lines; a trailing empty line has no tokens.
+    size_t insertLines(size_t k, size_t from, size_t to) {
+        vector<Line> fresh;
+        vector<size_t> starts;
+        size_t pos = from;
+        while (true) {
+            starts.push_back(pos);
+            fresh.push_back(Line{(int)lineNumberOfId.size(), false, false, {}});
+            lineNumberOfId.push_back(0);
+            size_t eol = text.find('\n', pos);
+            if (eol == string::npos || eol >= to) break;
+            pos = eol + 1;
+        }
+        lines.insert(lines.begin() + k, make_move_iterator(fresh.begin()), make_move_iterator(fresh.end()));
+        lineStart.insert(lineStart.begin() + k, starts.begin(), starts.end());
+        return fresh.size();
+    }
+
+    string symbolKey(string_view type, string_view lexeme) const {
+        string key(type);
+        key += '\0';
+        key += lexeme;
+        return key;
+    }
+
+    void dropSymbols(const Line &line) {
+        size_t start = lineStart[&line - &lines[0]];
+        for (auto &t : line.tokens) {
+            string_view type = symbolTypeName(t.cls);
+            if (type.empty()) continue;
+            auto it = symbols.find(symbolKey(type, string_view(text).substr(start + t.start, t.length)));
+            if (it == symbols.end()) continue;
+            auto use = it->second.uses.find(line.id);
+            if (use != it->second.uses.end() && --use->second.count == 0) it->second.uses.erase(use);
+            if (it->second.uses.empty()) symbols.erase(it);
+        }
+    }
+
+    void lexOne(size_t k, bool entryState) {
+        Line &line = lines[k];
+        line.entryState = entryState;
+        line.tokens.clear();
+        bool state = entryState;
+        const char *begin = text.data() + lineStart[k];
+        lexLine(string_view(begin, lineEnd(k) - lineStart[k]), k + 1, state, [&](const Token &t) {
+            uint32_t start = t.text.data() - begin;
+            line.tokens.push_back(LineToken{t.cls, start, (uint32_t)t.text.size()});
+            string_view type = symbolTypeName(t.cls);
+            if (type.empty()) return;
+            Symbol &sym = symbols[symbolKey(type, t.text)];
+            if (sym.lexeme.empty()) {
+                sym.lexeme = string(t.text);
+                sym.type = type;
+                sym.constant = t.cls == INTEGER || t.cls == FLOAT;
+                sym.value = t.value;
+            }
+            Usage &use = sym.uses[line.id];
+            use.count++;
+            use.firstColumn = min(use.firstColumn, (int)start);
+        });
+        line.exitState = state;
+    }
+
+    // Lex lines [first, end) (new text), then continue until the states agree
+    int relex(size_t first, size_t end) {
+        bool state = first > 0 ? lines[first - 1].exitState : false;
+        size_t k = first;
+        for (; k < lines.size(); k++) {
+            if (k >= end) {
+                if (lines[k].entryState == state) break;
+                dropSymbols(lines[k]);
+            }
+            lexOne(k, state);
+            state = lines[k].exitState;
+        }
+        for (size_t j = first; j < lines.size(); j++) lineNumberOfId[lines[j].id] = j + 1;
+        return k - first;
+    }
+};
+
+// Editor-style driver for IncrementalLexer. Commands on stdin:
+//   edit FROM TO LEN   then LEN raw bytes: replace bytes [FROM, TO) of the buffer
+//   tokens             print the token stream like process() does
+//   table              print the symbol table and constant pool
+//   quit
+void processIncremental(const string &filename) {
+    ifstream file(filename, ios::binary);
+    if (!file.is_open()) {
+        cout << "Error opening file\n";
+        return;
+    }
+    stringstream buffer;
+    buffer << file.rdbuf();
+
+    IncrementalLexer lexer;
+    lexer.reset(buffer.str());
+    cout << "Lexed " << lexer.lineCount() << " lines\n";
+
+    string cmd;
+    while (cin >> cmd) {
+        if (cmd == "edit") {
+            size_t from, to, len;
+            cin >> from >> to >> len;
+            cin.get(); // the separator after LEN
+            string replacement(len, '\0');
+            cin.read(&replacement[0], len);
+            int relexed = lexer.edit(from, to, replacement);
+            cout << "Re-lexed " << relexed << " of " << lexer.lineCount() << " lines\n";
+        } else if (cmd == "tokens") {
+            lexer.forEachToken(printToken);
+        } else if (cmd == "table") {
+            printSymbolTable(cout, lexer.symbolTable());
+            ConstantPool pool;
+            vector<ConstantEntry> entries;
+            lexer.constants(pool, entries);
+            printConstantPool(cout, pool, entries);
+        } else if (cmd == "quit") {
+            break;
+        }
+        cout << flush;
+    }
+}
+
+// ---------- Batch mode ----------
+// Lexes many files on a work-stealing pool (BATCH_LEX.h) and merges their
+// symbol tables and constant pools into one cross-reference whose usages are
+// (file, line) pairs.
+
+struct FileSymbol {
+    string_view lexeme;  // interned in the worker's arena
+    TokenClass cls;
+    LinePostings lines;
+};
+
+struct FileXref {
+    string path;
+    bool ok = false;
+    size_t bytes = 0, tokens = 0;
+    vector<FileSymbol> symbols;  // first-occurrence order
+    ConstantPool pool;           // numbers, by decoded value
+    vector<ConstantEntry> constants;  // parallel to pool
+};
+
+// Lex one file without printing. The lexeme alone decides the token class of
+// what is left once numbers go to the constant pool (identifiers start with a
+// letter, literals with a quote), so symbols are keyed by lexeme.
+void lexFileXref(FileXref &fx, LexemeArena &arena) {
+    LEX_STATS_PHASE("batch lex");
+    MappedFile file;
+    if (!file.open(fx.path)) return;
+    fx.ok = true;
+
+    string_view text = file.view();
+    fx.bytes = text.size();
+    unordered_map<string_view, int> index;
+    bool inMultiComment = false;
+    forEachLine(text, 0, 1, [&](string_view line, int lineNo) {
+        lexLine(line, lineNo, inMultiComment, [&](const Token &t) {
+            fx.tokens++;
+            LEX_STATS_TOKEN(t.cls);
+            if (t.cls == INTEGER || t.cls == FLOAT) {
+                addConstant(t, fx.pool, fx.constants, arena);
+                return;
+            }
+            if (symbolTypeName(t.cls).empty()) return;
+            auto it = index.try_emplace(t.text, fx.symbols.size()).first;
+            if (it->second == (int)fx.symbols.size()) fx.symbols.push_back(FileSymbol{t.text, t.cls, {}});
+            fx.symbols[it->second].lines.add(t.line);
+        });
+    });
+
+    // the mapping goes away with this function
+    for (auto &sym : fx.symbols) sym.lexeme = arena.intern(sym.lexeme);
+}
+
+// Global cross-reference entry; its usages stay in the per-file tables
+struct XrefEntry {
+    int entryNo;
+    string_view lexeme, tokenType;
+    vector<pair<int, const FileSymbol *>> files;  // (file index, symbol in that file)
+};
+
+// Global constant pool entry, parallel to the global ConstantPool
+struct XrefConstant {
+    vector<string_view> spellings;  // first-seen order over all files
+    vector<pair<int, const ConstantEntry *>> files;
+};
+
+void processBatch(const string &source, int nThreads) {
+    vector<string> paths = batchFiles(source);
+    if (paths.empty()) {
+        cout << "No files to lex in " << source << "\n";
+        return;
+    }
+    if (nThreads <= 0) nThreads = max(1u, thread::hardware_concurrency());
+
+    vector<FileXref> files(paths.size());
+    for (size_t k = 0; k < paths.size(); k++) files[k].path = paths[k];
+
+    auto t0 = chrono::steady_clock::now();
+    vector<LexemeArena> arenas(nThreads);
+    runBatch(paths, nThreads, [&](size_t k, int worker) { lexFileXref(files[k], arenas[worker]); });
+    auto t1 = chrono::steady_clock::now();
+
+    // merge in file order, so the table does not depend on the scheduling
+    vector<XrefEntry> xref;
+    unordered_map<string_view, int> index;
+    ConstantPool pool;
+    vector<XrefConstant> constants;
+    size_t bytes = 0, tokens = 0;
+    for (size_t f = 0; f < files.size(); f++) {
+        if (!files[f].ok) {
+            cout << "Error opening file: " << files[f].path << "\n";
+            continue;
+        }
+        bytes += files[f].bytes;
+        tokens += files[f].tokens;
+        for (auto &sym : files[f].symbols) {
+            auto it = index.try_emplace(sym.lexeme, xref.size()).first;
+            if (it->second == (int)xref.size())
+                xref.push_back(XrefEntry{(int)xref.size() + 1, sym.lexeme, symbolTypeName(sym.cls), {}});
+            xref[it->second].files.push_back({(int)f, &sym});
+        }
+        for (size_t k = 0; k < files[f].constants.size(); k++) {
+            size_t g = pool.intern(files[f].pool[k]);
+            if (g == constants.size()) constants.emplace_back();
+            XrefConstant &c = constants[g];
+            for (auto sp : files[f].constants[k].spellings)
+                if (find(c.spellings.begin(), c.spellings.end(), sp) == c.spellings.end()) c.spellings.push_back(sp);
+            c.files.push_back({(int)f, &files[f].constants[k]});
+        }
+    }
+    auto t2 = chrono::steady_clock::now();
+
+    cout << "\n===== GLOBAL SYMBOL TABLE =====\n";
+    cout << "Entry\tLexeme\t\tToken Type\tDeclared\tUsed (file: lines)\n";
+    for (auto &e : xref) {
+        auto &first = e.files.front();
         cout << e.entryNo << "\t" << e.lexeme << "\t\t" << e.tokenType << "\t\t"
-             << e.lineDeclared << "\t\t";
-        for (int ln : e.lineUsed) cout << ln << " ";
-        cout << endl;
+             << files[first.first].path << ":" << *first.second->lines.begin() << "\t";
+        for (size_t k = 0; k < e.files.size(); k++) {
+            cout << (k ? "; " : "") << files[e.files[k].first].path << ":";
+            for (int ln : e.files[k].second->lines) cout << " " << ln;
+        }
+        cout << '\n';
+    }
+
+    cout << "\n===== GLOBAL CONSTANT POOL =====\n";
+    cout << "Entry\tValue\t\tType\t\tSpellings\tUsed (file: lines)\n";
+    for (size_t k = 0; k < constants.size(); k++) {
+        cout << k + 1 << "\t" << formatNumericValue(pool[k]) << "\t\t" << numericTypeName(pool[k].type) << "\t\t";
+        for (auto sp : constants[k].spellings) cout << sp << " ";
+        cout << "\t";
+        for (size_t j = 0; j < constants[k].files.size(); j++) {
+            cout << (j ? "; " : "") << files[constants[k].files[j].first].path << ":";
+            for (int ln : constants[k].files[j].second->lineUsed) cout << " " << ln;
+        }
+        cout << '\n';
     }
+
+    if (!indexPath.empty()) {
+        XrefIndexWriter index;
+        for (auto &fx : files) index.addFile(fx.path);
+        for (auto &e : xref) {
+            index.beginSymbol(e.lexeme, e.tokenType);
+            for (auto &[f, sym] : e.files) addPostings(index, f, sym->lines);
+        }
+        for (size_t k = 0; k < constants.size(); k++) {
+            beginConstant(index, pool[k]);
+            for (auto &[f, c] : constants[k].files) addPostings(index, f, c->lineUsed);
+        }
+        saveIndex(index);
+    }
+
+    double lexSecs = chrono::duration<double>(t1 - t0).count();
+    double mergeSecs = chrono::duration<double>(t2 - t1).count();
+    cerr << "Lexed " << files.size() << " files, " << bytes << " bytes, " << tokens << " tokens on "
+         << nThreads << " threads: " << fixed << setprecision(3) << lexSecs << " s ("
+         << setprecision(1) << bytes / 1e6 / max(lexSecs, 1e-9) << " MB/s), merge "
+         << setprecision(3) << mergeSecs << " s\n";
 }
-int main() {
-    string name;
-    cout << "Enter file name: ";
-    cin >> name;
-    process(name);
+
+int main(int argc, char *argv[]) {
+    bool useMmap = false, incremental = false;
+    int threads = 0;
+    string name, batchSource;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--mmap") useMmap = true;
+        else if (arg == "--parallel" && a + 1 < argc) threads = atoi(argv[++a]);
+        else if (arg == "--binary" && a + 1 < argc) binaryPath = argv[++a];
+        else if (arg == "--incremental") incremental = true;
+        else if (arg == "--scoped") scopedMode = true;
+        else if (arg == "--index" && a + 1 < argc) indexPath = argv[++a];
+        else if (arg == "--preprocess") preprocessMode = true;
+        else if (arg == "--max-errors" && a + 1 < argc) errorBudget.limit = atol(argv[++a]);
+        else if (arg == "-I" && a + 1 < argc) includeDirs.push_back(argv[++a]);
+        else if (arg.rfind("-I", 0) == 0 && arg.size() > 2) includeDirs.push_back(arg.substr(2));
+        else if (arg == "--scan" && a + 1 < argc) {
+            if (!selectScanKernels(argv[++a])) cerr << "Unknown or unsupported scan kernels " << argv[a] << "\n";
+        }
+        else if (arg == "--batch" && a + 1 < argc) batchSource = argv[++a];
+        else name = arg;
+    }
+    if (preprocessMode && !binaryPath.empty()) {
+        // stream offsets point into one source file; preprocessed tokens come from several
+        cerr << "--binary cannot be combined with --preprocess\n";
+        return 1;
+    }
+    activeBudget = &errorBudget;  // this thread lexes in file order
+    LEX_STATS_PROGRAM("LEXICAL_TABLE", tokenKindNames);
+    if (!batchSource.empty()) {
+        processBatch(batchSource, threads);
+        return 0;
+    }
+    if (name.empty()) {
+        cout << "Enter file name: ";
+        cin >> name;
+    }
+    if (incremental) {
+        processIncremental(name);
+        return 0;
+    }
+    if (preprocessMode) process(name);
+    else if (threads > 0) processParallel(name, threads);
+    else if (useMmap || !binaryPath.empty()) processMapped(name);
+    else process(name);
+    if (!indexPath.empty()) writeSymbolIndex(name);
 }
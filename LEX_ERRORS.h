@@ -0,0 +1,91 @@
+// Lexical error budget shared by lab1.cpp and LEXICAL_TABLE.cpp.
+//
+// The lexers report a run of bytes that cannot start a token as one error
+// with a column range. Only errorBudget.limit errors are printed
+// (--max-errors N, where 0 means no limit); later ones are just counted. A
+// lexer running with activeBudget set also stops tokenising bad input once
+// the budget is spent: at the next bad byte it skips to a resync point
+// (whitespace, ';', '{' or '}') and emits nothing for the skipped bytes, so
+// binary or non-C input costs a byte scan instead of megabytes of output.
+//
+// activeBudget is per thread. Threads that lex ahead of time (--parallel
+// workers) leave it unset; the thread that prints the tokens in file order
+// finishes the file itself once the budget runs out.
+#ifndef LEX_ERRORS_H
+#define LEX_ERRORS_H
+
+#include <cstddef>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+struct LexErrorBudget {
+    long limit = 1000;
+    long reported = 0, suppressed = 0;
+    size_t skippedBytes = 0;
+
+    bool exhausted() const { return limit > 0 && reported >= limit; }
+
+    // Counts an error; true if it is still within the budget and should be printed
+    bool report() {
+        if (exhausted()) {
+            suppressed++;
+            return false;
+        }
+        reported++;
+        return true;
+    }
+
+    void skipped(size_t bytes) {
+        suppressed++;
+        skippedBytes += bytes;
+    }
+};
+
+inline LexErrorBudget errorBudget;
+inline thread_local LexErrorBudget *activeBudget = nullptr;
+
+inline bool isResyncPoint(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r') || c == ';' || c == '{' || c == '}';
+}
+
+// First index >= i that is a resync point, or len
+inline size_t skipToResyncPoint(const char *p, size_t i, size_t len) {
+    while (i < len && !isResyncPoint(p[i])) i++;
+    return i;
+}
+
+// Bad bytes as printable text: control and non-ASCII bytes as \xNN, long runs cut short
+inline std::string escapeBytes(std::string_view s, size_t maxBytes = 32) {
+    std::string out;
+    for (size_t k = 0; k < s.size() && k < maxBytes; k++) {
+        unsigned char c = s[k];
+        if (c >= 0x20 && c < 0x7f) {
+            out += (char)c;
+        } else {
+            char hex[5];
+            snprintf(hex, sizeof hex, "\\x%02X", c);
+            out += hex;
+        }
+    }
+    if (s.size() > maxBytes) out += "...";
+    return out;
+}
+
+// "line 3, column 5" or "line 3, columns 5-9"
+inline std::string errorPosition(int line, int column, size_t length) {
+    std::string at = "line " + std::to_string(line);
+    if (length <= 1) return at + ", column " + std::to_string(column);
+    return at + ", columns " + std::to_string(column) + "-" + std::to_string(column + length - 1);
+}
+
+// One line once the lexer is done, if anything went unreported
+inline void printErrorSummary(std::ostream &out, const char *prefix) {
+    if (!errorBudget.suppressed) return;
+    out << prefix << errorBudget.suppressed << " more errors not shown (limit " << errorBudget.limit << ")";
+    if (errorBudget.skippedBytes) out << ", " << errorBudget.skippedBytes << " bytes skipped to resynchronise";
+    out << '\n';
+}
+
+#endif
@@ -0,0 +1,206 @@
+// Opt-in instrumentation for lab1.cpp and LEXICAL_TABLE.cpp. Build with
+// -DLEX_STATS to turn it on; without it every LEX_STATS_* macro expands to
+// nothing and this header declares nothing.
+//
+//   LEX_STATS_PROGRAM(name, kindNames)  once in main: labels the report
+//   LEX_STATS_TOKEN(kind)               a token of kind (index into kindNames)
+//   LEX_STATS_BYTES(field, n)           n bytes of whitespace / comment skipped
+//   LEX_STATS_PROBE(steps)              a symbol-table lookup that took steps extra slots
+//   LEX_STATS_PHASE("name")             times the rest of the enclosing scope
+//
+// Heap allocations are counted by replacing the global operator new / delete.
+// At exit a JSON report goes to the file named by $LEX_STATS_FILE, or to stderr.
+//
+// Hot counters are per thread and are added to the totals when the thread
+// ends, so --parallel and --batch workers do not contend on them. --parallel
+// workers lex some lines twice, once per entry state; they take their skipped
+// byte counts per line (lexStatsTakeSkipped) and the driver adds back only the
+// run it keeps (PARALLEL_LEX.h).
+#ifndef LEX_STATS_H
+#define LEX_STATS_H
+
+#ifdef LEX_STATS
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+const int LEX_STATS_KINDS = 16;
+const int LEX_STATS_PROBE_BUCKETS = 6;  // 0, 1, 2, 3, 4-7, 8+ extra slots
+const int LEX_STATS_PHASES = 16;
+
+struct LexCounterValues {
+    uint64_t tokens[LEX_STATS_KINDS];
+    uint64_t whitespace, comment;
+    uint64_t probes, probeSteps, probeMax;
+    uint64_t probeHistogram[LEX_STATS_PROBE_BUCKETS];
+
+    void addTo(LexCounterValues &total) const {
+        for (int k = 0; k < LEX_STATS_KINDS; k++) total.tokens[k] += tokens[k];
+        total.whitespace += whitespace;
+        total.comment += comment;
+        total.probes += probes;
+        total.probeSteps += probeSteps;
+        if (probeMax > total.probeMax) total.probeMax = probeMax;
+        for (int k = 0; k < LEX_STATS_PROBE_BUCKETS; k++) total.probeHistogram[k] += probeHistogram[k];
+    }
+};
+
+inline std::mutex lexStatsLock;
+inline LexCounterValues lexStatsTotal{};
+
+struct LexThreadCounters : LexCounterValues {
+    ~LexThreadCounters() {
+        std::lock_guard<std::mutex> guard(lexStatsLock);
+        addTo(lexStatsTotal);
+    }
+};
+inline thread_local LexThreadCounters lexCounters{};
+
+struct LexSkippedBytes {
+    uint64_t whitespace, comment;
+};
+
+// This thread's skipped bytes since the last take, which are then cleared
+inline LexSkippedBytes lexStatsTakeSkipped() {
+    LexSkippedBytes s{lexCounters.whitespace, lexCounters.comment};
+    lexCounters.whitespace = lexCounters.comment = 0;
+    return s;
+}
+
+inline void lexStatsAddSkipped(const LexSkippedBytes &s) {
+    lexCounters.whitespace += s.whitespace;
+    lexCounters.comment += s.comment;
+}
+
+inline std::atomic<uint64_t> lexAllocations{0}, lexAllocatedBytes{0}, lexFrees{0};
+
+struct LexPhaseTotal {
+    const char *name;
+    uint64_t nanoseconds, calls;
+};
+inline LexPhaseTotal lexPhases[LEX_STATS_PHASES];
+
+class LexPhase {
+public:
+    explicit LexPhase(const char *name) : name(name), start(std::chrono::steady_clock::now()) {}
+    ~LexPhase() {
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        std::lock_guard<std::mutex> guard(lexStatsLock);
+        for (auto &p : lexPhases) {
+            if (p.name && strcmp(p.name, name) != 0) continue;
+            p.name = name;
+            p.nanoseconds += ns;
+            p.calls++;
+            return;
+        }
+    }
+
+private:
+    const char *name;
+    std::chrono::steady_clock::time_point start;
+};
+
+inline void lexStatsProbe(uint64_t steps) {
+    lexCounters.probes++;
+    lexCounters.probeSteps += steps;
+    if (steps > lexCounters.probeMax) lexCounters.probeMax = steps;
+    lexCounters.probeHistogram[steps < 4 ? steps : steps < 8 ? 4 : 5]++;
+}
+
+// Writes the report when the program exits; the main thread's counters have
+// been added to the totals by then
+class LexStatsReport {
+public:
+    LexStatsReport() : start(std::chrono::steady_clock::now()) {}
+
+    void label(const char *programName, const std::vector<std::string> &names) {
+        program = programName;
+        kindNames = names;
+    }
+
+    ~LexStatsReport() {
+        double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const char *path = getenv("LEX_STATS_FILE");
+        FILE *out = path ? fopen(path, "w") : nullptr;
+        if (!out) out = stderr;
+        const LexCounterValues &c = lexStatsTotal;
+
+        fprintf(out, "{\n  \"program\": \"%s\",\n  \"seconds\": %.6f,\n  \"tokens\": {", program, total);
+        uint64_t tokenCount = 0;
+        for (size_t k = 0; k < kindNames.size() && k < (size_t)LEX_STATS_KINDS; k++) {
+            fprintf(out, "%s\"%s\": %llu", k ? ", " : "", kindNames[k].c_str(), (unsigned long long)c.tokens[k]);
+            tokenCount += c.tokens[k];
+        }
+        fprintf(out, "},\n  \"tokenTotal\": %llu,\n", (unsigned long long)tokenCount);
+        fprintf(out, "  \"skippedBytes\": {\"whitespace\": %llu, \"comment\": %llu},\n",
+                (unsigned long long)c.whitespace, (unsigned long long)c.comment);
+        fprintf(out, "  \"heap\": {\"allocations\": %llu, \"bytes\": %llu, \"frees\": %llu, \"perToken\": %.3f},\n",
+                (unsigned long long)lexAllocations.load(), (unsigned long long)lexAllocatedBytes.load(),
+                (unsigned long long)lexFrees.load(), tokenCount ? (double)lexAllocations.load() / tokenCount : 0.0);
+        fprintf(out, "  \"symbolProbes\": {\"lookups\": %llu, \"extraSlots\": %llu, \"mean\": %.3f, \"max\": %llu, "
+                     "\"histogram\": {\"0\": %llu, \"1\": %llu, \"2\": %llu, \"3\": %llu, \"4-7\": %llu, \"8+\": %llu}},\n",
+                (unsigned long long)c.probes, (unsigned long long)c.probeSteps,
+                c.probes ? (double)c.probeSteps / c.probes : 0.0, (unsigned long long)c.probeMax,
+                (unsigned long long)c.probeHistogram[0], (unsigned long long)c.probeHistogram[1],
+                (unsigned long long)c.probeHistogram[2], (unsigned long long)c.probeHistogram[3],
+                (unsigned long long)c.probeHistogram[4], (unsigned long long)c.probeHistogram[5]);
+        fprintf(out, "  \"phases\": {");
+        for (int k = 0; k < LEX_STATS_PHASES && lexPhases[k].name; k++)
+            fprintf(out, "%s\n    \"%s\": {\"seconds\": %.6f, \"calls\": %llu}", k ? "," : "", lexPhases[k].name,
+                    lexPhases[k].nanoseconds / 1e9, (unsigned long long)lexPhases[k].calls);
+        fprintf(out, "\n  }\n}\n");
+        if (out != stderr) fclose(out);
+    }
+
+private:
+    const char *program = "";
+    std::vector<std::string> kindNames;
+    std::chrono::steady_clock::time_point start;
+};
+inline LexStatsReport lexStatsReport;
+
+// Counting replacements for the global allocation functions
+inline void *lexStatsAllocate(std::size_t n) {
+    lexAllocations.fetch_add(1, std::memory_order_relaxed);
+    lexAllocatedBytes.fetch_add(n, std::memory_order_relaxed);
+    if (void *p = malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+inline void lexStatsFree(void *p) {
+    if (p) lexFrees.fetch_add(1, std::memory_order_relaxed);
+    free(p);
+}
+void *operator new(std::size_t n) { return lexStatsAllocate(n); }
+void *operator new[](std::size_t n) { return lexStatsAllocate(n); }
+void operator delete(void *p) noexcept { lexStatsFree(p); }
+void operator delete[](void *p) noexcept { lexStatsFree(p); }
+void operator delete(void *p, std::size_t) noexcept { lexStatsFree(p); }
+void operator delete[](void *p, std::size_t) noexcept { lexStatsFree(p); }
+
+#define LEX_STATS_CONCAT2(a, b) a##b
+#define LEX_STATS_CONCAT(a, b) LEX_STATS_CONCAT2(a, b)
+#define LEX_STATS_PROGRAM(name, kindNames) lexStatsReport.label(name, kindNames)
+#define LEX_STATS_TOKEN(kind) (lexCounters.tokens[(kind) % LEX_STATS_KINDS]++)
+#define LEX_STATS_BYTES(field, n) (lexCounters.field += (n))
+#define LEX_STATS_PROBE(steps) lexStatsProbe(steps)
+#define LEX_STATS_PHASE(name) LexPhase LEX_STATS_CONCAT(lexPhase, __LINE__)(name)
+
+#else
+
+#define LEX_STATS_PROGRAM(name, kindNames) ((void)0)
+#define LEX_STATS_TOKEN(kind) ((void)0)
+#define LEX_STATS_BYTES(field, n) ((void)0)
+#define LEX_STATS_PROBE(steps) ((void)0)
+#define LEX_STATS_PHASE(name) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,96 @@
+// Compile-time character classes and keyword perfect hash shared by lab1.cpp,
+// LEXICAL_TABLE.cpp, ALL-CODES/third.cpp and CHAR_CLASS_BENCH.cpp.
+//
+// Each lexer declares its keywords, operators and special symbols as plain
+// lists and builds both tables from them at compile time:
+//
+//   constexpr string_view keywordList[] = {"int", "if", ...};
+//   constexpr string_view operatorList[] = {"=", "==", ...};
+//   constexpr string_view specialChars = "(){};,";
+//   constexpr CharClassTable charClass = makeCharClass(operatorList, specialChars);
+//   constexpr KeywordTable keywordTable = makeKeywordTable(keywordList);
+//   charClass.has(c, CC_DIGIT | CC_ID_START)   one table load
+//   keywordTable.find(word)                    index in keywordList, -1 if not a keyword
+//
+// CC_OP marks the first character of every operator. The keyword seed is
+// searched so that every keyword gets its own slot; a lookup is one hash, one
+// table load and one compare.
+#ifndef LEX_TABLES_H
+#define LEX_TABLES_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+enum : unsigned char { CC_SPACE = 1, CC_ID_START = 2, CC_ID_CHAR = 4, CC_DIGIT = 8, CC_OP = 16, CC_SPECIAL = 32 };
+
+struct CharClassTable {
+    std::array<unsigned char, 256> bits{};
+
+    constexpr bool has(char c, unsigned char cls) const { return bits[(unsigned char)c] & cls; }
+};
+
+// Operators given as the characters that can start one
+constexpr CharClassTable makeCharClass(std::string_view operatorChars, std::string_view specialChars) {
+    CharClassTable t{};
+    for (int c = 0; c < 256; c++) {
+        if (c == ' ' || (c >= '\t' && c <= '\r')) t.bits[c] |= CC_SPACE;
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') t.bits[c] |= CC_ID_START | CC_ID_CHAR;
+        if (c >= '0' && c <= '9') t.bits[c] |= CC_DIGIT | CC_ID_CHAR;
+    }
+    for (char c : operatorChars) t.bits[(unsigned char)c] |= CC_OP;
+    for (char c : specialChars) t.bits[(unsigned char)c] |= CC_SPECIAL;
+    return t;
+}
+
+template <size_t N>
+constexpr CharClassTable makeCharClass(const std::string_view (&operators)[N], std::string_view specialChars) {
+    CharClassTable t = makeCharClass(std::string_view(), specialChars);
+    for (std::string_view op : operators) t.bits[(unsigned char)op[0]] |= CC_OP;
+    return t;
+}
+
+constexpr int KEYWORD_BITS = 6;
+constexpr size_t KEYWORD_SLOTS = size_t(1) << KEYWORD_BITS;
+
+constexpr uint32_t keywordHash(std::string_view s, uint32_t seed) {
+    uint32_t h = seed ^ (uint32_t)s.size();
+    h = (h ^ (unsigned char)s[0]) * 0x9E3779B1u;
+    h = (h ^ (unsigned char)s[s.size() / 2]) * 0x85EBCA77u;
+    h = (h ^ (unsigned char)s[s.size() - 1]) * 0xC2B2AE3Du;
+    return h >> (32 - KEYWORD_BITS);
+}
+
+struct KeywordTable {
+    const std::string_view *keywords = nullptr;
+    uint32_t seed = 0;
+    std::array<signed char, KEYWORD_SLOTS> slots{};
+
+    constexpr int find(std::string_view word) const {
+        if (word.empty()) return -1;
+        int k = slots[keywordHash(word, seed)];
+        return k >= 0 && keywords[k] == word ? k : -1;
+    }
+};
+
+// Failing to find a seed is a compile error: a throw cannot be evaluated in a
+// constant expression.
+template <size_t N>
+constexpr KeywordTable makeKeywordTable(const std::string_view (&keywords)[N]) {
+    static_assert(N < KEYWORD_SLOTS, "too many keywords for the hash table");
+    for (uint32_t seed = 0; seed < 100000; seed++) {
+        KeywordTable t{keywords, seed, {}};
+        for (auto &slot : t.slots) slot = -1;
+        bool ok = true;
+        for (size_t k = 0; k < N && ok; k++) {
+            signed char &slot = t.slots[keywordHash(keywords[k], seed)];
+            if (slot >= 0) ok = false;
+            slot = k;
+        }
+        if (ok) return t;
+    }
+    throw "no perfect hash seed for the keyword list";
+}
+
+#endif
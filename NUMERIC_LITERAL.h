@@ -0,0 +1,207 @@
+// Numeric literal scanning and decoding shared by lab1.cpp and LEXICAL_TABLE.cpp.
+//
+//   NumericLiteral lit = scanNumericLiteral(p, len);  // p[0] is a digit
+//   lit.length   bytes that belong to the literal (at least 1)
+//   lit.error    nullptr, or why the spelling is not a valid constant
+//   lit.value    typed value; later stages use it instead of reparsing the text
+//
+// Accepted forms:
+//   decimal, octal (leading 0) and hex (0x) integers, with u / l / ll suffixes in either order
+//   decimal floats with a fraction and/or an exponent, with an f or l suffix
+// Letters or digits running on from a literal that do not form a valid suffix
+// are taken into the literal, which is then reported as invalid ("10abc").
+// Hex floats are not recognised. Long doubles are held as doubles.
+//
+// Integers get their C type (int, long, ... on LP64) from the value and the
+// suffix, so `1`, `0x1` and `01` decode to the same NumericValue. A
+// ConstantPool interns values so that each one is stored once.
+#ifndef NUMERIC_LITERAL_H
+#define NUMERIC_LITERAL_H
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+enum class NumericType : uint8_t { Int, UnsignedInt, Long, UnsignedLong, LongLong, UnsignedLongLong, Float, Double, LongDouble };
+
+inline const char *numericTypeName(NumericType t) {
+    static const char *names[] = {"int", "unsigned int", "long", "unsigned long", "long long",
+                                  "unsigned long long", "float", "double", "long double"};
+    return names[(int)t];
+}
+
+struct NumericValue {
+    NumericType type = NumericType::Int;
+    uint64_t bits = 0;  // the integer, or the bit pattern of the double
+
+    bool isFloating() const { return type >= NumericType::Float; }
+    uint64_t integer() const { return bits; }
+    double floating() const {
+        double d;
+        memcpy(&d, &bits, sizeof d);
+        return d;
+    }
+    static NumericValue ofFloating(NumericType type, double d) {
+        NumericValue v{type, 0};
+        memcpy(&v.bits, &d, sizeof d);
+        return v;
+    }
+    bool operator==(const NumericValue &o) const { return type == o.type && bits == o.bits; }
+};
+
+struct NumericValueHash {
+    size_t operator()(const NumericValue &v) const { return (v.bits * 0x9E3779B97F4A7C15ULL) ^ (size_t)v.type; }
+};
+
+// Shortest text that reads back as the same value
+inline std::string formatNumericValue(const NumericValue &v) {
+    char buf[64];
+    std::to_chars_result r;
+    if (v.type == NumericType::Float) r = std::to_chars(buf, buf + sizeof buf, (float)v.floating());
+    else if (v.isFloating()) r = std::to_chars(buf, buf + sizeof buf, v.floating());
+    else r = std::to_chars(buf, buf + sizeof buf, v.integer());
+    std::string text(buf, r.ptr);
+    // keep floating values recognisable: 1.0, not 1
+    if (v.isFloating() && text.find_first_of(".eni") == std::string::npos) text += ".0";
+    return text;
+}
+
+struct NumericLiteral {
+    size_t length;
+    NumericValue value;
+    const char *error;
+};
+
+inline bool numericIsDigit(char c) { return c >= '0' && c <= '9'; }
+inline bool numericIsHexDigit(char c) { return numericIsDigit(c) || ((c | 0x20) >= 'a' && (c | 0x20) <= 'f'); }
+inline bool numericIsIdentifierChar(char c) {
+    return numericIsDigit(c) || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') || c == '_';
+}
+
+// First integer type, in C's order, that the suffix allows and the value fits
+inline NumericType integerType(uint64_t value, bool decimal, bool isUnsigned, int longs) {
+    static const struct { NumericType type; bool isUnsigned; int longs; uint64_t max; } ladder[] = {
+        {NumericType::Int, false, 0, INT32_MAX},
+        {NumericType::UnsignedInt, true, 0, UINT32_MAX},
+        {NumericType::Long, false, 1, INT64_MAX},
+        {NumericType::UnsignedLong, true, 1, UINT64_MAX},
+        {NumericType::LongLong, false, 2, INT64_MAX},
+        {NumericType::UnsignedLongLong, true, 2, UINT64_MAX},
+    };
+    for (auto &step : ladder) {
+        if (step.longs < longs || (isUnsigned && !step.isUnsigned)) continue;
+        // unsuffixed decimal constants never become unsigned
+        if (decimal && !isUnsigned && step.isUnsigned) continue;
+        if (value <= step.max) return step.type;
+    }
+    return NumericType::UnsignedLongLong;  // too big for long long: GCC makes it unsigned too
+}
+
+inline NumericLiteral scanNumericLiteral(const char *p, size_t len) {
+    NumericLiteral lit{0, {}, nullptr};
+    size_t i = 0, digitsStart = 0;
+    int base = 10;
+    bool floating = false;
+
+    if (len > 2 && p[0] == '0' && (p[1] | 0x20) == 'x' && numericIsHexDigit(p[2])) {
+        base = 16;
+        i = digitsStart = 2;
+        while (i < len && numericIsHexDigit(p[i])) i++;
+    } else {
+        while (i < len && numericIsDigit(p[i])) i++;
+        if (i < len && p[i] == '.') {
+            floating = true;
+            i++;
+            while (i < len && numericIsDigit(p[i])) i++;
+        }
+        // the exponent needs a digit, else the 'e' starts the suffix
+        if (i < len && (p[i] | 0x20) == 'e') {
+            size_t k = i + 1;
+            if (k < len && (p[k] == '+' || p[k] == '-')) k++;
+            if (k < len && numericIsDigit(p[k])) {
+                floating = true;
+                i = k;
+                while (i < len && numericIsDigit(p[i])) i++;
+            }
+        }
+        if (!floating && i > 1 && p[0] == '0') {
+            base = 8;
+            digitsStart = 1;
+        }
+    }
+    size_t digitsEnd = i;
+    while (i < len && numericIsIdentifierChar(p[i])) i++;
+    lit.length = i;
+    std::string_view suffix(p + digitsEnd, i - digitsEnd);
+
+    if (floating) {
+        NumericType type = NumericType::Double;
+        if (suffix == "f" || suffix == "F") type = NumericType::Float;
+        else if (suffix == "l" || suffix == "L") type = NumericType::LongDouble;
+        else if (!suffix.empty()) {
+            lit.error = "invalid suffix on floating constant";
+            return lit;
+        }
+        double d = 0;
+        if (std::from_chars(p, p + digitsEnd, d).ec != std::errc()) {
+            lit.error = "floating constant out of range";
+            return lit;
+        }
+        if (type == NumericType::Float) d = (float)d;
+        lit.value = NumericValue::ofFloating(type, d);
+        return lit;
+    }
+
+    bool isUnsigned = false;
+    int longs = 0;
+    for (size_t k = 0; k < suffix.size(); k++) {
+        char c = suffix[k];
+        if ((c | 0x20) == 'u' && !isUnsigned) {
+            isUnsigned = true;
+        } else if ((c | 0x20) == 'l' && !longs) {
+            // "ll" and "LL", but not "lL"
+            longs = (k + 1 < suffix.size() && suffix[k + 1] == c) ? 2 : 1;
+            k += longs - 1;
+        } else {
+            lit.error = "invalid suffix on integer constant";
+            return lit;
+        }
+    }
+    for (size_t k = digitsStart; k < digitsEnd; k++)
+        if (base == 8 && p[k] > '7') {
+            lit.error = "invalid digit in octal constant";
+            return lit;
+        }
+
+    uint64_t value = 0;
+    if (digitsEnd > digitsStart &&
+        std::from_chars(p + digitsStart, p + digitsEnd, value, base).ec != std::errc()) {
+        lit.error = "integer constant is too large";
+        return lit;
+    }
+    lit.value = NumericValue{integerType(value, base == 10, isUnsigned, longs), value};
+    return lit;
+}
+
+// Distinct values in first-seen order
+class ConstantPool {
+public:
+    // Index of v in the pool, adding it on first sight
+    size_t intern(const NumericValue &v) {
+        auto it = index.try_emplace(v, values.size()).first;
+        if (it->second == values.size()) values.push_back(v);
+        return it->second;
+    }
+    size_t size() const { return values.size(); }
+    const NumericValue &operator[](size_t k) const { return values[k]; }
+
+private:
+    std::vector<NumericValue> values;
+    std::unordered_map<NumericValue, size_t, NumericValueHash> index;
+};
+
+#endif
@@ -0,0 +1,74 @@
+// Longest-match operator recogniser shared by lab1.cpp, LEXICAL_TABLE.cpp and
+// ALL-CODES/third.cpp.
+//
+// Each lexer declares its operators as a plain list and builds the trie at
+// compile time:
+//
+//   constexpr string_view operatorList[] = {"=", "==", "<", "<<", "<<=", ...};
+//   constexpr auto operatorTrie = makeOperatorTrie(operatorList);
+//   size_t n = operatorTrie.match(p, len);   // length of the longest operator at p, 0 if none
+//
+// match() walks one trie node per byte through a small table indexed by
+// (node, character); nothing is allocated or hashed. Operators must be
+// ASCII; the list may be in any order.
+#ifndef OPERATOR_TRIE_H
+#define OPERATOR_TRIE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+constexpr size_t OPERATOR_TRIE_NODES = 64;     // trie nodes, root included
+constexpr size_t OPERATOR_TRIE_ALPHABET = 32;  // distinct operator characters + 1
+
+struct OperatorTrie {
+    std::array<uint8_t, 256> charIndex{};  // 0: cannot appear in an operator
+    std::array<std::array<uint8_t, OPERATOR_TRIE_ALPHABET>, OPERATOR_TRIE_NODES> child{};  // 0: no edge
+    std::array<uint8_t, OPERATOR_TRIE_NODES> length{};  // nonzero: an operator ends at this node
+    size_t nodes = 1;
+    size_t chars = 1;
+
+    constexpr size_t match(const char *p, size_t len) const {
+        size_t node = 0, best = 0;
+        for (size_t k = 0; k < len; k++) {
+            unsigned c = charIndex[(unsigned char)p[k]];
+            if (!c || !(node = child[node][c])) break;
+            if (length[node]) best = length[node];
+        }
+        return best;
+    }
+
+    constexpr bool isOperator(std::string_view s) const {
+        return !s.empty() && match(s.data(), s.size()) == s.size();
+    }
+};
+
+// Overflowing the fixed sizes is a compile error: a throw cannot be evaluated
+// in a constant expression.
+template <size_t N>
+constexpr OperatorTrie makeOperatorTrie(const std::string_view (&operators)[N]) {
+    OperatorTrie t{};
+    for (std::string_view op : operators) {
+        if (op.empty() || op.size() > 255) throw "operator length out of range";
+        size_t node = 0;
+        for (char ch : op) {
+            unsigned char u = ch;
+            if (u >= 128) throw "operators must be ASCII";
+            if (!t.charIndex[u]) {
+                if (t.chars == OPERATOR_TRIE_ALPHABET) throw "too many operator characters";
+                t.charIndex[u] = t.chars++;
+            }
+            uint8_t &next = t.child[node][t.charIndex[u]];
+            if (!next) {
+                if (t.nodes == OPERATOR_TRIE_NODES) throw "too many operator trie nodes";
+                next = t.nodes++;
+            }
+            node = next;
+        }
+        t.length[node] = op.size();
+    }
+    return t;
+}
+
+#endif
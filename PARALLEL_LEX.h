@@ -0,0 +1,239 @@
+// File mapping and the chunked parallel driver shared by lab1.cpp and
+// LEXICAL_TABLE.cpp (--mmap, --binary, --parallel).
+//
+// Each lexer hands its own line function over as an object, together with the
+// token type it produces and the function that consumes tokens:
+//
+//   constexpr auto lineLexer = [](string_view line, int lineNo, bool &inComment, auto &&emit, size_t from) {
+//       lexLine(line, lineNo, inComment, emit, from);
+//   };
+//   MappedFile file;
+//   if (!file.open(path)) ...
+//   lexLines(file.view(), 0, 1, 0, lineLexer, emitToken);          // in order, on this thread
+//   lexParallel<Token>(file.view(), nThreads, lineLexer, emitToken); // same calls to emitToken
+//
+// Token needs `text` (a string_view into the file) and `line`. The only state
+// a lexer carries from one line to the next is the multi-line comment flag
+// (string literals end at the end of a line), so a chunk of whole lines can
+// be lexed before its entry state is known: once assuming it starts outside a
+// comment and once assuming it starts inside one.
+#ifndef PARALLEL_LEX_H
+#define PARALLEL_LEX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "LEX_ERRORS.h"
+#include "LEX_STATS.h"
+
+// Read-only mapping of a whole file
+struct MappedFile {
+    const char *data = nullptr;
+    size_t size = 0;
+
+    bool open(const std::string &filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) < 0) { ::close(fd); return false; }
+        size = st.st_size;
+        if (size > 0) {
+            void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) { ::close(fd); return false; }
+            madvise(p, size, MADV_SEQUENTIAL);
+            data = (const char *)p;
+        }
+        ::close(fd);
+        return true;
+    }
+    ~MappedFile() {
+        if (data) munmap((void *)data, size);
+    }
+    std::string_view view() const { return std::string_view(data, size); }
+};
+
+// fn(line, lineNo) for every line of text from byte pos on, numbered from
+// lineNo. getline() semantics: a trailing newline does not start another
+// line. fn may return false to stop early.
+template <class Fn>
+void forEachLine(std::string_view text, size_t pos, int lineNo, Fn &&fn) {
+    while (pos < text.size()) {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string_view::npos) eol = text.size();
+        if constexpr (std::is_same_v<decltype(fn(text, lineNo)), bool>) {
+            if (!fn(text.substr(pos, eol - pos), lineNo++)) return;
+        } else {
+            fn(text.substr(pos, eol - pos), lineNo++);
+        }
+        pos = eol + 1;
+    }
+}
+
+// Lex text in order from byte pos, which is column `from` of line lineNo and
+// outside any comment
+template <class LineLexer, class Emit>
+void lexLines(std::string_view text, size_t pos, int lineNo, size_t from, LineLexer &&lex, Emit &&emit) {
+    LEX_STATS_PHASE("lex");
+    bool inMultiComment = false;
+    forEachLine(text, pos, lineNo, [&](std::string_view line, int n) {
+        lex(line, n, inMultiComment, emit, from);
+        from = 0;
+    });
+}
+
+const size_t PARALLEL_CHUNK_SIZE = 4 << 20;
+
+template <class Token>
+struct LexedChunk {
+    std::string_view text;
+    int lines = 0;
+    std::vector<Token> tokens[2];  // by entry state, line numbers local to the chunk
+    bool exitState[2];
+    size_t joinToken = 0;          // tokens[1] continues with tokens[0][joinToken..]
+#ifdef LEX_STATS
+    // Skipped bytes per line by entry state; skipped[1] stops where the runs
+    // converge. Only the kept run's counts are added to the totals.
+    std::vector<LexSkippedBytes> skipped[2];
+
+    LexSkippedBytes keptSkipped(bool entryState, size_t line) const {
+        return entryState && line < skipped[1].size() ? skipped[1][line] : skipped[0][line];
+    }
+#endif
+};
+
+template <class Token, class LineLexer>
+void lexChunk(LexedChunk<Token> &c, const LineLexer &lex) {
+    LEX_STATS_PHASE("chunk lex");  // summed over the workers
+#ifdef LEX_STATS
+    lexStatsTakeSkipped();
+#endif
+
+    // entry state "outside a comment", lexed to the end of the chunk
+    std::vector<bool> stateAfter;
+    std::vector<size_t> lineStart;
+    bool state = false;
+    auto keep0 = [&](const Token &t) { c.tokens[0].push_back(t); };
+    forEachLine(c.text, 0, 1, [&](std::string_view line, int lineNo) {
+        lineStart.push_back(c.tokens[0].size());
+        lex(line, lineNo, state, keep0, 0);
+        stateAfter.push_back(state);
+#ifdef LEX_STATS
+        c.skipped[0].push_back(lexStatsTakeSkipped());
+#endif
+    });
+    c.lines = lineStart.size();
+    c.exitState[0] = state;
+
+    // entry state "inside a comment", only until it agrees with the first run
+    state = true;
+    c.exitState[1] = true;
+    c.joinToken = c.tokens[0].size();
+    auto keep1 = [&](const Token &t) { c.tokens[1].push_back(t); };
+    forEachLine(c.text, 0, 1, [&](std::string_view line, int lineNo) {
+        lex(line, lineNo, state, keep1, 0);
+#ifdef LEX_STATS
+        c.skipped[1].push_back(lexStatsTakeSkipped());
+#endif
+        c.exitState[1] = state;
+        if (state != stateAfter[lineNo - 1]) return true;
+        // converged: the rest of the chunk is the same as the first run
+        c.joinToken = lineNo < c.lines ? lineStart[lineNo] : c.tokens[0].size();
+        c.exitState[1] = c.exitState[0];
+        return false;
+    });
+}
+
+#ifdef LEX_STATS
+// The error budget ran out at byte `at`, on line `line` of chunk c (entered in
+// state `entryState`), and the rest of the file is lexed again from there. Add
+// the kept run's skipped bytes up to `at`: whole lines before it, and that line
+// less what the worker counted from `at` on (outside a comment, as at any
+// token end, and lexed again here without a budget, as the worker did).
+template <class Token, class LineLexer>
+void keepSkippedBefore(const LexedChunk<Token> &c, bool entryState, int line, std::string_view text,
+                       size_t lineStart, size_t at, const LineLexer &lex) {
+    LexSkippedBytes before = lexStatsTakeSkipped();
+    size_t eol = std::min(text.find('\n', at), text.size());
+    bool state = false;
+    LexErrorBudget *budget = activeBudget;
+    activeBudget = nullptr;
+    lex(text.substr(lineStart, eol - lineStart), line, state, [](const Token &) {}, at - lineStart);
+    activeBudget = budget;
+    LexSkippedBytes rest = lexStatsTakeSkipped();
+
+    lexStatsAddSkipped(before);
+    for (int k = 0; k < line - 1; k++) lexStatsAddSkipped(c.keptSkipped(entryState, k));
+    LexSkippedBytes last = c.keptSkipped(entryState, line - 1);
+    lexStatsAddSkipped(LexSkippedBytes{last.whitespace - rest.whitespace, last.comment - rest.comment});
+}
+#endif
+
+// Lex text in chunks on nThreads threads, then pass the tokens to emit in file
+// order: the same calls lexLines() makes. Once the error budget runs out the
+// workers' tokens are dropped and the rest of the file is lexed here, in
+// order, where the lexer can resync.
+template <class Token, class LineLexer, class Emit>
+void lexParallel(std::string_view text, int nThreads, const LineLexer &lex, Emit &&emit) {
+    size_t pos = 0;
+    int lineBase = 0;
+    bool state = false;
+
+    while (pos < text.size()) {
+        // cut the next round of chunks at line boundaries
+        std::vector<LexedChunk<Token>> chunks;
+        while ((int)chunks.size() < nThreads && pos < text.size()) {
+            size_t end = text.find('\n', std::min(pos + PARALLEL_CHUNK_SIZE, text.size()) - 1);
+            end = (end == std::string_view::npos) ? text.size() : end + 1;
+            chunks.emplace_back();
+            chunks.back().text = text.substr(pos, end - pos);
+            pos = end;
+        }
+
+        std::vector<std::thread> workers;
+        for (auto &c : chunks) workers.emplace_back([&c, &lex] { lexChunk(c, lex); });
+        for (auto &w : workers) w.join();
+
+        // pick each chunk's run from the real entry state
+        for (auto &c : chunks) {
+            LEX_STATS_PHASE("stitch");
+            auto replay = [&](const Token &t) {
+                Token shifted = t;
+                shifted.line += lineBase;
+                bool spent = errorBudget.exhausted();
+                emit(shifted);
+                if (spent || !errorBudget.exhausted()) return true;
+                size_t at = t.text.data() + t.text.size() - text.data();
+                size_t lineStart = text.rfind('\n', at - 1);
+                lineStart = (lineStart == std::string_view::npos) ? 0 : lineStart + 1;
+#ifdef LEX_STATS
+                keepSkippedBefore(c, state, t.line, text, lineStart, at, lex);
+#endif
+                lexLines(text, lineStart, shifted.line, at - lineStart, lex, emit);
+                return false;
+            };
+            bool more = true;
+            if (!state) {
+                for (size_t k = 0; more && k < c.tokens[0].size(); k++) more = replay(c.tokens[0][k]);
+            } else {
+                for (size_t k = 0; more && k < c.tokens[1].size(); k++) more = replay(c.tokens[1][k]);
+                for (size_t k = c.joinToken; more && k < c.tokens[0].size(); k++) more = replay(c.tokens[0][k]);
+            }
+            if (!more) return;
+#ifdef LEX_STATS
+            for (int k = 0; k < c.lines; k++) lexStatsAddSkipped(c.keptSkipped(state, k));
+#endif
+            state = c.exitState[state];
+            lineBase += c.lines;
+        }
+    }
+}
+
+#endif
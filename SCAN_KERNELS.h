@@ -0,0 +1,161 @@
+// Byte-scanning kernels for the lexers' hot loops (lab1.cpp, LEXICAL_TABLE.cpp).
+//
+//   scan.skipSpaces(p, i, len)      first index >= i that is not ' ' or '\t'..'\r'
+//   scan.findEither(p, i, len, a, b) first index >= i holding a or b
+//   scan.findByte(p, i, len, c)      first index >= i holding c
+//
+// All three return len when nothing is found and never read p[len] or beyond.
+// There are scalar, SSE2 (16 bytes per step) and AVX2 (32 bytes per step)
+// versions. `scan` defaults to SSE2 where the build has it, else scalar. AVX2
+// is opt-in: lexer tokens are short, so the wider loads rarely pay for their
+// setup and measured slower than SSE2 on the benchmark corpus.
+// selectScanKernels("scalar" | "sse2" | "avx2") overrides it for comparisons.
+#ifndef SCAN_KERNELS_H
+#define SCAN_KERNELS_H
+
+#include <cstddef>
+#include <string>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define SCAN_KERNELS_X86 1
+#endif
+
+inline bool scanIsSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// ---------- Scalar ----------
+inline size_t scalarSkipSpaces(const char *p, size_t i, size_t len) {
+    while (i < len && scanIsSpace(p[i])) i++;
+    return i;
+}
+
+inline size_t scalarFindEither(const char *p, size_t i, size_t len, char a, char b) {
+    while (i < len && p[i] != a && p[i] != b) i++;
+    return i;
+}
+
+inline size_t scalarFindByte(const char *p, size_t i, size_t len, char c) {
+    while (i < len && p[i] != c) i++;
+    return i;
+}
+
+#ifdef SCAN_KERNELS_X86
+// ---------- SSE2 ----------
+// A byte is whitespace if it is ' ' or (byte - '\t') <= 4 unsigned, which
+// min_epu8 answers without a signed compare.
+inline __m128i sse2SpaceMask(__m128i v) {
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+    __m128i inRange = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(4)), shifted);
+    return _mm_or_si128(inRange, _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+}
+
+inline size_t sse2SkipSpaces(const char *p, size_t i, size_t len) {
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        unsigned other = ~_mm_movemask_epi8(sse2SpaceMask(v)) & 0xFFFF;
+        if (other) return i + __builtin_ctz(other);
+    }
+    return scalarSkipSpaces(p, i, len);
+}
+
+inline size_t sse2FindEither(const char *p, size_t i, size_t len, char a, char b) {
+    __m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b);
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        unsigned hit = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)));
+        if (hit) return i + __builtin_ctz(hit);
+    }
+    return scalarFindEither(p, i, len, a, b);
+}
+
+inline size_t sse2FindByte(const char *p, size_t i, size_t len, char c) {
+    __m128i vc = _mm_set1_epi8(c);
+    for (; i + 16 <= len; i += 16) {
+        unsigned hit = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + i)), vc));
+        if (hit) return i + __builtin_ctz(hit);
+    }
+    return scalarFindByte(p, i, len, c);
+}
+
+// ---------- AVX2 ----------
+// Compiled for AVX2 regardless of -march; only called after the CPU check.
+__attribute__((target("avx2"))) inline size_t avx2SkipSpaces(const char *p, size_t i, size_t len) {
+    const __m256i tab = _mm256_set1_epi8('\t'), four = _mm256_set1_epi8(4), space = _mm256_set1_epi8(' ');
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+        __m256i shifted = _mm256_sub_epi8(v, tab);
+        __m256i isSpace = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(shifted, four), shifted),
+                                          _mm256_cmpeq_epi8(v, space));
+        unsigned other = ~(unsigned)_mm256_movemask_epi8(isSpace);
+        if (other) return i + __builtin_ctz(other);
+    }
+    return sse2SkipSpaces(p, i, len);
+}
+
+__attribute__((target("avx2"))) inline size_t avx2FindEither(const char *p, size_t i, size_t len, char a, char b) {
+    __m256i va = _mm256_set1_epi8(a), vb = _mm256_set1_epi8(b);
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+        unsigned hit = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, va), _mm256_cmpeq_epi8(v, vb)));
+        if (hit) return i + __builtin_ctz(hit);
+    }
+    return sse2FindEither(p, i, len, a, b);
+}
+
+__attribute__((target("avx2"))) inline size_t avx2FindByte(const char *p, size_t i, size_t len, char c) {
+    __m256i vc = _mm256_set1_epi8(c);
+    for (; i + 32 <= len; i += 32) {
+        unsigned hit = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(p + i)), vc));
+        if (hit) return i + __builtin_ctz(hit);
+    }
+    return sse2FindByte(p, i, len, c);
+}
+#endif
+
+// ---------- Runtime dispatch ----------
+struct ScanKernels {
+    const char *name;
+    size_t (*skipSpaces)(const char *, size_t, size_t);
+    size_t (*findEither)(const char *, size_t, size_t, char, char);
+    size_t (*findByte)(const char *, size_t, size_t, char);
+};
+
+inline const ScanKernels scalarScanKernels = {"scalar", scalarSkipSpaces, scalarFindEither, scalarFindByte};
+#ifdef SCAN_KERNELS_X86
+inline const ScanKernels sse2ScanKernels = {"sse2", sse2SkipSpaces, sse2FindEither, sse2FindByte};
+inline const ScanKernels avx2ScanKernels = {"avx2", avx2SkipSpaces, avx2FindEither, avx2FindByte};
+#endif
+
+inline bool cpuHasAvx2() {
+#ifdef SCAN_KERNELS_X86
+    __builtin_cpu_init(); // may run before the runtime's own CPU detection
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+inline ScanKernels bestScanKernels() {
+#ifdef SCAN_KERNELS_X86
+    return sse2ScanKernels;
+#else
+    return scalarScanKernels;
+#endif
+}
+
+inline ScanKernels scan = bestScanKernels();
+
+// false if the name is unknown or the CPU lacks the instructions
+inline bool selectScanKernels(const std::string &name) {
+    if (name == "scalar") scan = scalarScanKernels;
+#ifdef SCAN_KERNELS_X86
+    else if (name == "sse2") scan = sse2ScanKernels;
+    else if (name == "avx2" && cpuHasAvx2()) scan = avx2ScanKernels;
+#endif
+    else return false;
+    return true;
+}
+
+#endif
@@ -0,0 +1,220 @@
+// Binary columnar token stream written by lab1.cpp / LEXICAL_TABLE.cpp (--binary)
+// and read by parsers running in another process.
+//
+// Layout (little-endian on every host; big-endian hosts swap on write and read;
+// every section starts on an 8-byte boundary):
+//   header   "TOKS"  u32 version  u32 kindCount  u32 sourcePathLength
+//            source path bytes, then kindCount NUL-terminated kind names   (padded to 8)
+//   block    u32 count  u32 reserved
+//            u8  kind[count]                                               (padded to 8)
+//            u64 offset[count]   byte offset of the lexeme in the source file
+//            u32 length[count]   lexeme length in bytes
+//            u32 line[count]
+//            u64 value[count]    decoded Integer / Float payload: the integer, or the
+//                                bits of the double; 0 for other kinds
+//   ...      more blocks; a block with count == 0 ends the stream
+//
+// Lexemes are not copied into the stream: a reader maps sourcePath and takes
+// source.substr(offset[i], length[i]). Kind values index kindNames. Numbers
+// come decoded in value[], so readers do not parse their text again.
+//
+// Reading:
+//   TokenStreamReader in;
+//   if (!in.open("tokens.bin")) ...            // "-" reads stdin
+//   TokenBlock b;
+//   while (in.nextBlock(b))
+//       for (size_t i = 0; i < b.count; i++) use(b.kind[i], b.offset[i], b.length[i], b.line[i], b.value[i]);
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+const char TOKEN_STREAM_MAGIC[4] = {'T', 'O', 'K', 'S'};
+const uint32_t TOKEN_STREAM_VERSION = 2;
+const size_t TOKEN_STREAM_BLOCK = 1 << 16;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+const bool TOKEN_STREAM_SWAP = true;
+#else
+const bool TOKEN_STREAM_SWAP = false;
+#endif
+
+// Converts n values between host order and the stream's little-endian order
+inline void tokenStreamOrder(uint32_t *v, size_t n) {
+    if (TOKEN_STREAM_SWAP)
+        for (size_t i = 0; i < n; i++) v[i] = __builtin_bswap32(v[i]);
+}
+inline void tokenStreamOrder(uint64_t *v, size_t n) {
+    if (TOKEN_STREAM_SWAP)
+        for (size_t i = 0; i < n; i++) v[i] = __builtin_bswap64(v[i]);
+}
+
+class TokenStreamWriter {
+public:
+    // path "-" writes to stdout
+    bool open(const std::string &path, const std::string &sourcePath,
+              const std::vector<std::string> &kindNames) {
+        out = (path == "-") ? stdout : fopen(path.c_str(), "wb");
+        if (!out) return false;
+        setvbuf(out, nullptr, _IOFBF, 1 << 20);
+
+        std::string names;
+        for (auto &name : kindNames) names += name + '\0';
+        uint32_t header[3] = {TOKEN_STREAM_VERSION, (uint32_t)kindNames.size(), (uint32_t)sourcePath.size()};
+        tokenStreamOrder(header, 3);
+        fwrite(TOKEN_STREAM_MAGIC, 1, 4, out);
+        fwrite(header, sizeof(header), 1, out);
+        fwrite(sourcePath.data(), 1, sourcePath.size(), out);
+        fwrite(names.data(), 1, names.size(), out);
+        pad(16 + sourcePath.size() + names.size());
+        return true;
+    }
+
+    void add(uint8_t kind, uint64_t offset, uint32_t length, uint32_t line, uint64_t value = 0) {
+        kinds.push_back(kind);
+        offsets.push_back(offset);
+        lengths.push_back(length);
+        lines.push_back(line);
+        values.push_back(value);
+        if (kinds.size() == TOKEN_STREAM_BLOCK) flushBlock();
+    }
+
+    // Writes the last block and the terminator
+    void close() {
+        if (!out) return;
+        flushBlock();
+        uint32_t end[2] = {0, 0};
+        fwrite(end, sizeof(end), 1, out);
+        if (out == stdout) fflush(out);
+        else fclose(out);
+        out = nullptr;
+    }
+
+    ~TokenStreamWriter() { close(); }
+
+private:
+    FILE *out = nullptr;
+    std::vector<uint8_t> kinds;
+    std::vector<uint64_t> offsets, values;
+    std::vector<uint32_t> lengths, lines;
+
+    void pad(size_t written) {
+        static const char zeros[8] = {};
+        if (written % 8) fwrite(zeros, 1, 8 - written % 8, out);
+    }
+
+    void flushBlock() {
+        if (kinds.empty()) return;
+        uint32_t head[2] = {(uint32_t)kinds.size(), 0};
+        tokenStreamOrder(head, 2);
+        tokenStreamOrder(offsets.data(), offsets.size());
+        tokenStreamOrder(lengths.data(), lengths.size());
+        tokenStreamOrder(lines.data(), lines.size());
+        tokenStreamOrder(values.data(), values.size());
+        fwrite(head, sizeof(head), 1, out);
+        fwrite(kinds.data(), 1, kinds.size(), out);
+        pad(kinds.size());
+        fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), out);
+        fwrite(lengths.data(), sizeof(uint32_t), lengths.size(), out);
+        fwrite(lines.data(), sizeof(uint32_t), lines.size(), out);
+        fwrite(values.data(), sizeof(uint64_t), values.size(), out);
+        kinds.clear();
+        offsets.clear();
+        lengths.clear();
+        lines.clear();
+        values.clear();
+    }
+};
+
+// One block of tokens; the arrays stay valid until the next nextBlock() call
+struct TokenBlock {
+    size_t count;
+    const uint8_t *kind;
+    const uint64_t *offset;
+    const uint32_t *length;
+    const uint32_t *line;
+    const uint64_t *value;
+};
+
+class TokenStreamReader {
+public:
+    // path "-" reads stdin, so the reader works at the end of a pipe
+    bool open(const std::string &path) {
+        in = (path == "-") ? stdin : fopen(path.c_str(), "rb");
+        if (!in) return false;
+        setvbuf(in, nullptr, _IOFBF, 1 << 20);
+
+        char magic[4];
+        uint32_t header[3];
+        if (fread(magic, 1, 4, in) != 4 || memcmp(magic, TOKEN_STREAM_MAGIC, 4) != 0) return false;
+        if (fread(header, sizeof(header), 1, in) != 1) return false;
+        tokenStreamOrder(header, 3);
+        if (header[0] != TOKEN_STREAM_VERSION) return false;
+
+        path_.resize(header[2]);
+        if (fread(&path_[0], 1, path_.size(), in) != path_.size()) return false;
+        size_t consumed = 16 + path_.size();
+        for (uint32_t k = 0; k < header[1]; k++) {
+            std::string name;
+            int c;
+            while ((c = fgetc(in)) > 0) name += (char)c;
+            if (c < 0) return false;
+            consumed += name.size() + 1;
+            names.push_back(name);
+        }
+        return skipPad(consumed);
+    }
+
+    const std::string &sourcePath() const { return path_; }
+    const std::vector<std::string> &kindNames() const { return names; }
+
+    // Reads the next block; false at the end of the stream or on a short read
+    bool nextBlock(TokenBlock &block) {
+        uint32_t head[2];
+        if (!in || fread(head, sizeof(head), 1, in) != 1) return false;
+        tokenStreamOrder(head, 2);
+        if (head[0] == 0) return false;
+        size_t n = head[0];
+        kinds.resize(n);
+        offsets.resize(n);
+        lengths.resize(n);
+        lines.resize(n);
+        values.resize(n);
+        if (fread(kinds.data(), 1, n, in) != n || !skipPad(n) ||
+            fread(offsets.data(), sizeof(uint64_t), n, in) != n ||
+            fread(lengths.data(), sizeof(uint32_t), n, in) != n ||
+            fread(lines.data(), sizeof(uint32_t), n, in) != n ||
+            fread(values.data(), sizeof(uint64_t), n, in) != n)
+            return false;
+        tokenStreamOrder(offsets.data(), n);
+        tokenStreamOrder(lengths.data(), n);
+        tokenStreamOrder(lines.data(), n);
+        tokenStreamOrder(values.data(), n);
+        block = TokenBlock{n, kinds.data(), offsets.data(), lengths.data(), lines.data(), values.data()};
+        return true;
+    }
+
+    ~TokenStreamReader() {
+        if (in && in != stdin) fclose(in);
+    }
+
+private:
+    FILE *in = nullptr;
+    std::string path_;
+    std::vector<std::string> names;
+    std::vector<uint8_t> kinds;
+    std::vector<uint64_t> offsets, values;
+    std::vector<uint32_t> lengths, lines;
+
+    bool skipPad(size_t consumed) {
+        char buf[8];
+        size_t n = consumed % 8 ? 8 - consumed % 8 : 0;
+        return fread(buf, 1, n, in) == n;
+    }
+};
+
+#endif
@@ -0,0 +1,250 @@
+// On-disk cross-reference index written by LEXICAL_TABLE.cpp (--index) and
+// read by XREF_QUERY.cpp. The file is mapped and used in place: a lookup is a
+// binary search over the symbol directory, with no parsing and no allocation.
+// open() checks every offset, length and posting once, so lookups on a corrupt
+// file cannot read outside the mapping.
+//
+// Layout (host byte order, every section starts on an 8-byte boundary). The
+// reader uses the mapping in place, so the structs are written as they are in
+// memory and only little-endian hosts are supported:
+//   header     "XREF"  u32 version  u32 fileCount  u32 symbolCount
+//              u64 postingCount  u64 stringBytes
+//              u64 filesOffset  u64 symbolsOffset  u64 postingsOffset  u64 stringsOffset
+//   files      XrefFile[fileCount]       path of each file in the string pool
+//   symbols    XrefSymbol[symbolCount]   sorted by (name, type) bytes
+//   postings   XrefPosting[postingCount] each symbol's (file, line) uses, contiguous
+//   strings    string pool; names, types and paths are stored once each
+//
+// Reading:
+//   XrefIndexReader index;
+//   if (!index.open("tree.xref")) ...
+//   for (const XrefSymbol *s = index.findFirst("main"); s && index.name(*s) == "main"; s++)
+//       for (auto &p : index.postings(*s)) use(index.path(p.file), p.line);
+#ifndef XREF_INDEX_H
+#define XREF_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "XREF_INDEX.h assumes a little-endian host");
+
+const char XREF_INDEX_MAGIC[4] = {'X', 'R', 'E', 'F'};
+const uint32_t XREF_INDEX_VERSION = 1;
+
+struct XrefHeader {
+    char magic[4];
+    uint32_t version, fileCount, symbolCount;
+    uint64_t postingCount, stringBytes;
+    uint64_t filesOffset, symbolsOffset, postingsOffset, stringsOffset;
+};
+
+struct XrefFile {
+    uint32_t pathOffset, pathLength;
+};
+
+struct XrefSymbol {
+    uint32_t nameOffset, nameLength;
+    uint32_t typeOffset, typeLength;
+    uint64_t firstPosting;  // index into postings
+    uint64_t postingCount;  // the first posting is where the symbol is declared
+};
+
+struct XrefPosting {
+    uint32_t file, line;
+};
+
+// Collects files and symbols in any order; write() sorts the directory.
+// Postings are added to the symbol begun last.
+class XrefIndexWriter {
+public:
+    uint32_t addFile(std::string_view path) {
+        files.push_back(XrefFile{pool(path), (uint32_t)path.size()});
+        return files.size() - 1;
+    }
+
+    void beginSymbol(std::string_view name, std::string_view type) {
+        symbols.push_back(XrefSymbol{pool(name), (uint32_t)name.size(), pool(type), (uint32_t)type.size(),
+                                     postings.size(), 0});
+    }
+
+    void addPosting(uint32_t file, uint32_t line) {
+        postings.push_back(XrefPosting{file, line});
+        symbols.back().postingCount++;
+    }
+
+    bool write(const std::string &path) {
+        auto key = [&](const XrefSymbol &s) {
+            return std::make_pair(std::string_view(strings).substr(s.nameOffset, s.nameLength),
+                                  std::string_view(strings).substr(s.typeOffset, s.typeLength));
+        };
+        std::sort(symbols.begin(), symbols.end(),
+                  [&](const XrefSymbol &a, const XrefSymbol &b) { return key(a) < key(b); });
+
+        XrefHeader h{};
+        memcpy(h.magic, XREF_INDEX_MAGIC, 4);
+        h.version = XREF_INDEX_VERSION;
+        h.fileCount = files.size();
+        h.symbolCount = symbols.size();
+        h.postingCount = postings.size();
+        h.stringBytes = strings.size();
+        h.filesOffset = sizeof(XrefHeader);
+        h.symbolsOffset = align(h.filesOffset + files.size() * sizeof(XrefFile));
+        h.postingsOffset = align(h.symbolsOffset + symbols.size() * sizeof(XrefSymbol));
+        h.stringsOffset = align(h.postingsOffset + postings.size() * sizeof(XrefPosting));
+
+        FILE *out = fopen(path.c_str(), "wb");
+        if (!out) return false;
+        setvbuf(out, nullptr, _IOFBF, 1 << 20);
+        uint64_t written = 0;
+        // pads up to `at`, then writes n bytes; false on a short write
+        auto put = [&](const void *p, size_t n, uint64_t at) {
+            static const char zeros[8] = {};
+            size_t pad = at - written;
+            if (fwrite(zeros, 1, pad, out) != pad || fwrite(p, 1, n, out) != n) return false;
+            written = at + n;
+            return true;
+        };
+        bool ok = put(&h, sizeof(h), 0) &&
+                  put(files.data(), files.size() * sizeof(XrefFile), h.filesOffset) &&
+                  put(symbols.data(), symbols.size() * sizeof(XrefSymbol), h.symbolsOffset) &&
+                  put(postings.data(), postings.size() * sizeof(XrefPosting), h.postingsOffset) &&
+                  put(strings.data(), strings.size(), h.stringsOffset);
+        return fclose(out) == 0 && ok;
+    }
+
+private:
+    std::vector<XrefFile> files;
+    std::vector<XrefSymbol> symbols;
+    std::vector<XrefPosting> postings;
+    std::string strings;
+    std::unordered_map<std::string, uint32_t> pooled;
+
+    uint32_t pool(std::string_view s) {
+        auto it = pooled.try_emplace(std::string(s), (uint32_t)strings.size()).first;
+        if (it->second == strings.size()) strings.append(s);
+        return it->second;
+    }
+    static uint64_t align(uint64_t n) { return (n + 7) & ~uint64_t(7); }
+};
+
+class XrefIndexReader {
+public:
+    // false if the file is missing, not an index, truncated, or has an offset,
+    // length or posting outside its section
+    bool open(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(XrefHeader)) { ::close(fd); return false; }
+        size = st.st_size;
+        void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        base = (const char *)p;
+
+        const XrefHeader &h = *(const XrefHeader *)base;
+        if (memcmp(h.magic, XREF_INDEX_MAGIC, 4) != 0 || h.version != XREF_INDEX_VERSION ||
+            !fits(h.filesOffset, h.fileCount, sizeof(XrefFile)) ||
+            !fits(h.symbolsOffset, h.symbolCount, sizeof(XrefSymbol)) ||
+            !fits(h.postingsOffset, h.postingCount, sizeof(XrefPosting)) ||
+            !fits(h.stringsOffset, h.stringBytes, 1)) {
+            close();
+            return false;
+        }
+        fileTable = (const XrefFile *)(base + h.filesOffset);
+        symbolTable = (const XrefSymbol *)(base + h.symbolsOffset);
+        postingTable = (const XrefPosting *)(base + h.postingsOffset);
+        strings = std::string_view(base + h.stringsOffset, h.stringBytes);
+        fileCount = h.fileCount;
+        symbolCount = h.symbolCount;
+        if (!entriesValid(h.postingCount)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (base) munmap((void *)base, size);
+        base = nullptr;
+        fileCount = symbolCount = 0;
+    }
+    ~XrefIndexReader() { close(); }
+
+    const XrefSymbol *begin() const { return symbolTable; }
+    const XrefSymbol *end() const { return symbolTable + symbolCount; }
+    size_t files() const { return fileCount; }
+
+    std::string_view name(const XrefSymbol &s) const { return strings.substr(s.nameOffset, s.nameLength); }
+    std::string_view type(const XrefSymbol &s) const { return strings.substr(s.typeOffset, s.typeLength); }
+    std::string_view path(uint32_t file) const {
+        return strings.substr(fileTable[file].pathOffset, fileTable[file].pathLength);
+    }
+
+    struct PostingRange {
+        const XrefPosting *first, *last;
+        const XrefPosting *begin() const { return first; }
+        const XrefPosting *end() const { return last; }
+    };
+    PostingRange postings(const XrefSymbol &s) const {
+        return PostingRange{postingTable + s.firstPosting, postingTable + s.firstPosting + s.postingCount};
+    }
+
+    // First directory entry whose name is >= key (end() if none). Entries that
+    // share a name are adjacent, one per token type.
+    const XrefSymbol *lowerBound(std::string_view key) const {
+        return std::lower_bound(begin(), end(), key,
+                                [&](const XrefSymbol &s, std::string_view k) { return name(s) < k; });
+    }
+
+    // First entry named exactly key, or nullptr
+    const XrefSymbol *findFirst(std::string_view key) const {
+        const XrefSymbol *s = lowerBound(key);
+        return (s != end() && name(*s) == key) ? s : nullptr;
+    }
+
+private:
+    const char *base = nullptr;
+    size_t size = 0;
+    const XrefFile *fileTable = nullptr;
+    const XrefSymbol *symbolTable = nullptr;
+    const XrefPosting *postingTable = nullptr;
+    std::string_view strings;
+    size_t fileCount = 0, symbolCount = 0;
+
+    bool fits(uint64_t offset, uint64_t count, size_t width) const {
+        return offset <= size && offset % 8 == 0 && count <= (size - offset) / width;
+    }
+
+    bool inStrings(uint32_t offset, uint32_t length) const {
+        return offset <= strings.size() && length <= strings.size() - offset;
+    }
+
+    // Every path, name and type lies in the string pool, every posting range lies
+    // in the posting table, and every posting names a file in the file table
+    bool entriesValid(uint64_t postingCount) const {
+        for (size_t f = 0; f < fileCount; f++)
+            if (!inStrings(fileTable[f].pathOffset, fileTable[f].pathLength)) return false;
+        for (size_t i = 0; i < symbolCount; i++) {
+            const XrefSymbol &s = symbolTable[i];
+            if (!inStrings(s.nameOffset, s.nameLength) || !inStrings(s.typeOffset, s.typeLength) ||
+                s.firstPosting > postingCount || s.postingCount > postingCount - s.firstPosting)
+                return false;
+        }
+        for (uint64_t i = 0; i < postingCount; i++)
+            if (postingTable[i].file >= fileCount) return false;
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,84 @@
+// Answers "where is X used" from an index written by LEXICAL_TABLE --index,
+// without opening any source file.
+//
+//   ./XREF_QUERY tree.xref main count        look up the names given
+//   ./XREF_QUERY tree.xref                   read names from stdin, one per line
+//   ./XREF_QUERY --prefix tree.xref str      every symbol starting with "str"
+//
+// Lookup times are printed on stderr.
+#include <bits/stdc++.h>
+#include "XREF_INDEX.h"
+using namespace std;
+
+XrefIndexReader indexFile;
+bool prefixMode = false;
+size_t lookups = 0;
+double lookupSecs = 0;
+
+void printSymbol(const XrefSymbol &s) {
+    auto uses = indexFile.postings(s);
+    cout << indexFile.name(s) << "\t" << indexFile.type(s);
+    if (uses.begin() != uses.end())
+        cout << "\tdeclared " << indexFile.path(uses.begin()->file) << ":" << uses.begin()->line;
+    cout << "\n";
+
+    // postings are grouped by file, in line order
+    for (const XrefPosting *p = uses.begin(); p != uses.end();) {
+        uint32_t file = p->file;
+        cout << "\t" << indexFile.path(file) << ":";
+        for (; p != uses.end() && p->file == file; p++) cout << " " << p->line;
+        cout << "\n";
+    }
+}
+
+void query(string_view key) {
+    auto t0 = chrono::steady_clock::now();
+    const XrefSymbol *first = prefixMode ? indexFile.lowerBound(key) : indexFile.findFirst(key);
+    const XrefSymbol *last = first;
+    if (first) {
+        auto matches = [&](const XrefSymbol &s) {
+            string_view name = indexFile.name(s);
+            return prefixMode ? name.substr(0, key.size()) == key : name == key;
+        };
+        while (last != indexFile.end() && matches(*last)) last++;
+    }
+    lookupSecs += chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    lookups++;
+
+    if (first == last) {
+        cout << key << ": not found\n";
+        return;
+    }
+    for (const XrefSymbol *s = first; s != last; s++) printSymbol(*s);
+}
+
+int main(int argc, char *argv[]) {
+    string path;
+    vector<string> names;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--prefix") prefixMode = true;
+        else if (path.empty()) path = arg;
+        else names.push_back(arg);
+    }
+    if (path.empty()) {
+        cout << "Enter index file: ";
+        cin >> path;
+    }
+    if (!indexFile.open(path)) {
+        cout << "Error opening index " << path << "\n";
+        return 1;
+    }
+
+    if (!names.empty()) {
+        for (auto &name : names) query(name);
+    } else {
+        string name;
+        while (cin >> name) query(name);
+    }
+
+    if (lookups)
+        cerr << lookups << " lookups in " << fixed << setprecision(1) << lookupSecs * 1e6 << " us ("
+             << setprecision(2) << lookupSecs * 1e6 / lookups << " us each), "
+             << (indexFile.end() - indexFile.begin()) << " symbols in " << indexFile.files() << " files\n";
+}
@@ -1,27 +1,266 @@
 #include <iostream>
 #include <fstream>
-#include <cctype>
-#include <unordered_set>
+#include <array>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <climits>
+#include "TOKEN_STREAM.h"
+#include "SCAN_KERNELS.h"
+#include "OPERATOR_TRIE.h"
+#include "PARALLEL_LEX.h"
+#include "BATCH_LEX.h"
+#include "LEX_TABLES.h"
+#include "NUMERIC_LITERAL.h"
+#include "LEX_ERRORS.h"
+#include "LEX_STATS.h"
 using namespace std;
 
-unordered_set<string> keywords = {
+// Keywords
+constexpr string_view keywordList[] = {
     "int", "float", "if", "else", "while", "for", "return", "void", "char", "double", "long", "short", "switch", "case", "break", "continue", "default", "do", "struct", "typedef"
 };
 
-unordered_set<char> operators = {'+', '-', '*', '/', '=', '<', '>', '!', '%'};
-unordered_set<char> specialSymbols = {'(', ')', '{', '}', ';', ','};
+// Operators (lab1 counts every operator character on its own)
+constexpr string_view operatorList[] = {"+", "-", "*", "/", "=", "<", ">", "!", "%"};
+constexpr OperatorTrie operatorTrie = makeOperatorTrie(operatorList);
 
-bool isKeyword(const string& word) {
-    return keywords.find(word) != keywords.end();
+// Special Symbols
+constexpr string_view specialChars = "(){};,";
+
+// ---------- Character classes and keyword hash (LEX_TABLES.h) ----------
+constexpr CharClassTable charClass = makeCharClass(operatorList, specialChars);
+constexpr KeywordTable keywordTable = makeKeywordTable(keywordList);
+
+inline bool hasClass(char c, unsigned char cls) {
+    return charClass.has(c, cls);
+}
+
+bool isKeyword(string_view word) {
+    return keywordTable.find(word) >= 0;
 }
 
 bool isIdentifierStart(char ch) {
-    return isalpha(ch) || ch == '_';
+    return hasClass(ch, CC_ID_START);
 }
 
 bool isIdentifierChar(char ch) {
-    return isalnum(ch) || ch == '_';
+    return hasClass(ch, CC_ID_CHAR);
+}
+
+// Token classes produced by the lexer
+enum TokenClass { KEYWORD, IDENTIFIER, INTEGER, FLOAT, OPERATOR, SPECIAL, INVALID };
+
+// A token is a view into the current line, never a copy
+struct Token {
+    TokenClass cls;
+    string_view text;
+    int line;
+    NumericValue value{};  // decoded INTEGER / FLOAT
+    int column = 0;        // 1-based, set on INVALID tokens
+};
+
+// Counters
+int keywordCount = 0;
+int identifierCount = 0;
+int operatorCount = 0;
+int constantCount = 0;
+ConstantPool constantPool;  // distinct numeric values
+
+// Binary token stream (--binary). Kind names are in TokenClass order.
+const vector<string> tokenKindNames = {"Keyword", "Identifier", "Integer", "Float", "Operator",
+                                       "Special Symbol", "Invalid token"};
+string binaryPath;                     // empty: tokens are printed as text
+TokenStreamWriter tokenStream;
+const char *tokenStreamBase = nullptr; // start of the mapped file while the stream is open
+
+bool openTokenStream(const string& filename, const char *base) {
+    char resolved[PATH_MAX];
+    string source = realpath(filename.c_str(), resolved) ? resolved : filename;
+    if (!tokenStream.open(binaryPath, source, tokenKindNames)) {
+        cerr << "Error opening " << binaryPath << "\n";
+        return false;
+    }
+    tokenStreamBase = base;
+    return true;
+}
+
+// Print a token (or append it to the binary stream) and update the counters.
+// Invalid tokens past the error budget are counted, not printed or streamed.
+void emitToken(const Token &t) {
+    LEX_STATS_TOKEN(t.cls);
+    if (t.cls == INTEGER || t.cls == FLOAT) {
+        constantCount++;
+        constantPool.intern(t.value);
+    }
+    if (tokenStreamBase) {
+        if (t.cls == INVALID && !errorBudget.report()) return;
+        tokenStream.add(t.cls, t.text.data() - tokenStreamBase, t.text.size(), t.line, t.value.bits);
+        keywordCount += t.cls == KEYWORD;
+        identifierCount += t.cls == IDENTIFIER;
+        operatorCount += t.cls == OPERATOR;
+        return;
+    }
+    switch (t.cls) {
+    case KEYWORD:
+        cout << "Keyword: " << t.text << endl;
+        keywordCount++;
+        break;
+    case IDENTIFIER:
+        cout << "Identifier: " << t.text << endl;
+        identifierCount++;
+        break;
+    case INTEGER:
+        cout << "Integer: " << t.text << endl;
+        break;
+    case FLOAT:
+        cout << "Float: " << t.text << endl;
+        break;
+    case OPERATOR:
+        cout << "Operator: " << t.text << endl;
+        operatorCount++;
+        break;
+    case SPECIAL:
+        cout << "Special Symbol: " << t.text << endl;
+        break;
+    case INVALID:
+        if (!errorBudget.report()) break;
+        cout << "Error: Invalid token '" << escapeBytes(t.text) << "' at "
+             << errorPosition(t.line, t.column, t.text.size()) << "\n";
+        if (errorBudget.exhausted())
+            cout << "Error: " << errorBudget.limit << " errors reported; skipping further bad input\n";
+        break;
+    }
+}
+
+// Whether a token, whitespace or a comment can start with ch
+bool startsToken(char ch) {
+    return hasClass(ch, CC_SPACE | CC_ID_START | CC_DIGIT | CC_OP | CC_SPECIAL);
+}
+
+// Lex one line from column `from` on. inMultilineComment carries the comment state across lines.
+template <class Emit>
+void lexLine(string_view line, int lineNo, bool &inMultilineComment, Emit &&emit, size_t from = 0) {
+    size_t i = from;
+    size_t len = line.length();
+
+    while (i < len) {
+        char ch = line[i];
+
+        // Skip whitespace (runs of it with the vector kernel)
+        if (hasClass(ch, CC_SPACE)) {
+            size_t end = i + 1;
+            if (end < len && hasClass(line[end], CC_SPACE)) end = scan.skipSpaces(line.data(), end, len);
+            LEX_STATS_BYTES(whitespace, end - i);
+            i = end;
+            continue;
+        }
+
+        // Handle single-line comment
+        if (ch == '/' && i + 1 < len && line[i + 1] == '/') {
+            LEX_STATS_BYTES(comment, len - i);
+            break; // Skip rest of line
+        }
+
+        // Handle multi-line comment start
+        if (ch == '/' && i + 1 < len && line[i + 1] == '*') {
+            inMultilineComment = true;
+            LEX_STATS_BYTES(comment, 2);
+            i += 2;
+            continue;
+        }
+
+        // Inside multi-line comment: only '*' and '/' matter there,
+        // so jump to the next one
+        if (inMultilineComment) {
+            size_t end;
+            if (ch == '*' && i + 1 < len && line[i + 1] == '/') {
+                inMultilineComment = false;
+                end = i + 2;
+            } else {
+                end = scan.findEither(line.data(), i + 1, len, '*', '/');
+            }
+            LEX_STATS_BYTES(comment, end - i);
+            i = end;
+            continue;
+        }
+
+        // Handle Identifiers or Keywords
+        if (isIdentifierStart(ch)) {
+            size_t start = i;
+            while (i < len && isIdentifierChar(line[i])) i++;
+            string_view token = line.substr(start, i - start);
+            emit(Token{isKeyword(token) ? KEYWORD : IDENTIFIER, token, lineNo});
+            continue;
+        }
+
+        // Handle Numbers (hex, octal, exponents and suffixes; see NUMERIC_LITERAL.h)
+        if (hasClass(ch, CC_DIGIT)) {
+            NumericLiteral lit = scanNumericLiteral(line.data() + i, len - i);
+            TokenClass cls = lit.error ? INVALID : lit.value.isFloating() ? FLOAT : INTEGER;
+            emit(Token{cls, line.substr(i, lit.length), lineNo, lit.value, (int)i + 1});
+            i += lit.length;
+            continue;
+        }
+
+        // Handle Operators (longest match)
+        if (hasClass(ch, CC_OP)) {
+            size_t n = operatorTrie.match(line.data() + i, len - i);
+            emit(Token{OPERATOR, line.substr(i, n), lineNo});
+            i += n;
+            continue;
+        }
+
+        // Handle Special Symbols
+        if (hasClass(ch, CC_SPECIAL)) {
+            emit(Token{SPECIAL, line.substr(i, 1), lineNo});
+            i++;
+            continue;
+        }
+
+        // If none matched: one error for the whole run of bytes that cannot
+        // start a token, or, once the error budget is spent, a skip to a resync point
+        if (activeBudget && activeBudget->exhausted()) {
+            size_t start = i;
+            i = skipToResyncPoint(line.data(), i, len);
+            activeBudget->skipped(i - start);
+            continue;
+        }
+        size_t start = i++;
+        while (i < len && !startsToken(line[i])) i++;
+        emit(Token{INVALID, line.substr(start, i - start), lineNo, {}, (int)start + 1});
+    }
+}
+
+// lexLine() as an object, for the drivers in PARALLEL_LEX.h
+constexpr auto lineLexer = [](string_view line, int lineNo, bool &inMultilineComment, auto &&emit, size_t from) {
+    lexLine(line, lineNo, inMultilineComment, emit, from);
+};
+
+void printSummary(ostream& out = cout) {
+    out << "\nSummary:\n";
+    out << "Total Keywords: " << keywordCount << endl;
+    out << "Total Identifiers: " << identifierCount << endl;
+    out << "Total Operators: " << operatorCount << endl;
+    out << "Sum Total (Keywords + Identifiers + Operators): " 
+        << (keywordCount + identifierCount + operatorCount) << endl;
+    out << "Total Constants: " << constantCount << " (" << constantPool.size() << " distinct values)" << endl;
+}
+
+// Close the token stream, if any, and print the summary.
+// With the stream on stdout the summary goes to stderr.
+void finishOutput() {
+    LEX_STATS_PHASE("summary");
+    if (tokenStreamBase) {
+        tokenStream.close();
+        tokenStreamBase = nullptr;
+    }
+    printErrorSummary(binaryPath == "-" ? cerr : cout, "Error: ");
+    printSummary(binaryPath == "-" ? cerr : cout);
 }
 
 void processFile(const string& filename) {
@@ -31,120 +270,134 @@ void processFile(const string& filename) {
         return;
     }
 
-    // Counters
-    int keywordCount = 0;
-    int identifierCount = 0;
-    int operatorCount = 0;
-
     string line;
+    int lineNo = 0;
     bool inMultilineComment = false;
-    while (getline(file, line)) {
-        int i = 0;
-        int len = line.length();
+    {
+        LEX_STATS_PHASE("lex");
+        while (getline(file, line)) {
+            lineNo++;
+            lexLine(line, lineNo, inMultilineComment, emitToken);
+        }
+    }
 
-        while (i < len) {
-            char ch = line[i];
+    file.close();
 
-            // Skip whitespace
-            if (isspace(ch)) {
-                i++;
-                continue;
-            }
+    // Final Summary
+    LEX_STATS_PHASE("summary");
+    printErrorSummary(cout, "Error: ");
+    printSummary();
+}
 
-            // Handle single-line comment
-            if (ch == '/' && i + 1 < len && line[i + 1] == '/') {
-                break; // Skip rest of line
-            }
+// Same as processFile(), but lexes straight out of a mapping of the file
+void processFileMapped(const string& filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        cerr << "Error opening file.\n";
+        return;
+    }
 
-            // Handle multi-line comment start
-            if (ch == '/' && i + 1 < len && line[i + 1] == '*') {
-                inMultilineComment = true;
-                i += 2;
-                continue;
-            }
+    string_view text = file.view();
+    if (!binaryPath.empty() && !openTokenStream(filename, text.data())) return;
+    lexLines(text, 0, 1, 0, lineLexer, emitToken);
+    finishOutput();
+}
 
-            // Inside multi-line comment
-            if (inMultilineComment) {
-                if (ch == '*' && i + 1 < len && line[i + 1] == '/') {
-                    inMultilineComment = false;
-                    i += 2;
-                } else {
-                    i++;
-                }
-                continue;
-            }
+// Parallel mode: chunks of whole lines are lexed on nThreads threads and
+// stitched together in file order (see PARALLEL_LEX.h)
+void processFileParallel(const string& filename, int nThreads) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        cerr << "Error opening file.\n";
+        return;
+    }
 
-            // Handle Identifiers or Keywords
-            if (isIdentifierStart(ch)) {
-                string token;
-                while (i < len && isIdentifierChar(line[i])) {
-                    token += line[i++];
-                }
-                if (isKeyword(token)) {
-                    cout << "Keyword: " << token << endl;
-                    keywordCount++;
-                } else {
-                    cout << "Identifier: " << token << endl;
-                    identifierCount++;
-                }
-                continue;
-            }
+    string_view text = file.view();
+    if (!binaryPath.empty() && !openTokenStream(filename, text.data())) return;
+    lexParallel<Token>(text, nThreads, lineLexer, emitToken);
+    finishOutput();
+}
 
-            // Handle Numbers
-            if (isdigit(ch)) {
-                string number;
-                bool isFloat = false;
-                while (i < len && (isdigit(line[i]) || line[i] == '.')) {
-                    if (line[i] == '.') {
-                        if (isFloat) break; // More than one dot
-                        isFloat = true;
-                    }
-                    number += line[i++];
-                }
-                if (isFloat)
-                    cout << "Float: " << number << endl;
-                else
-                    cout << "Integer: " << number << endl;
-                continue;
-            }
+// Batch mode: many files on a work-stealing pool (BATCH_LEX.h), one summary
+// line per file plus the totals
+struct FileCounts {
+    bool ok = false;
+    int keywords = 0, identifiers = 0, operators = 0, constants = 0;
+    ConstantPool pool;
+};
 
-            // Handle Operators
-            if (operators.find(ch) != operators.end()) {
-                cout << "Operator: " << ch << endl;
-                operatorCount++;
-                i++;
-                continue;
-            }
+void countFile(const string& filename, FileCounts &counts) {
+    LEX_STATS_PHASE("batch lex");
+    MappedFile file;
+    if (!file.open(filename)) return;
+    counts.ok = true;
 
-            // Handle Special Symbols
-            if (specialSymbols.find(ch) != specialSymbols.end()) {
-                cout << "Special Symbol: " << ch << endl;
-                i++;
-                continue;
+    bool inMultilineComment = false;
+    forEachLine(file.view(), 0, 1, [&](string_view line, int lineNo) {
+        lexLine(line, lineNo, inMultilineComment, [&](const Token &t) {
+            LEX_STATS_TOKEN(t.cls);
+            counts.keywords += t.cls == KEYWORD;
+            counts.identifiers += t.cls == IDENTIFIER;
+            counts.operators += t.cls == OPERATOR;
+            if (t.cls == INTEGER || t.cls == FLOAT) {
+                counts.constants++;
+                counts.pool.intern(t.value);
             }
+        });
+    });
+}
 
-            // If none matched
-            cout << "Error: Invalid token starting with '" << ch << "'\n";
-            i++;
-        }
-    }
+// source is a directory (searched recursively for C/C++ files) or a list of paths
+void processBatch(const string& source, int nThreads) {
+    vector<string> paths = batchFiles(source);
+    if (nThreads <= 0) nThreads = max(1u, thread::hardware_concurrency());
 
-    file.close();
+    vector<FileCounts> counts(paths.size());
+    runBatch(paths, nThreads, [&](size_t k, int) { countFile(paths[k], counts[k]); });
 
-    // Final Summary
-    cout << "\nSummary:\n";
-    cout << "Total Keywords: " << keywordCount << endl;
-    cout << "Total Identifiers: " << identifierCount << endl;
-    cout << "Total Operators: " << operatorCount << endl;
-    cout << "Sum Total (Keywords + Identifiers + Operators): " 
-         << (keywordCount + identifierCount + operatorCount) << endl;
+    for (size_t k = 0; k < paths.size(); k++) {
+        if (!counts[k].ok) {
+            cerr << "Error opening file: " << paths[k] << "\n";
+            continue;
+        }
+        cout << paths[k] << ": Keywords " << counts[k].keywords << ", Identifiers " << counts[k].identifiers
+             << ", Operators " << counts[k].operators << "\n";
+        keywordCount += counts[k].keywords;
+        identifierCount += counts[k].identifiers;
+        operatorCount += counts[k].operators;
+        constantCount += counts[k].constants;
+        for (size_t v = 0; v < counts[k].pool.size(); v++) constantPool.intern(counts[k].pool[v]);
+    }
+    printSummary();
 }
 
-int main() {
-    string filename;
-    cout << "Enter the filename to analyze: ";
-    cin >> filename;
+int main(int argc, char *argv[]) {
+    int threads = 0;
+    string filename, batchSource;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--parallel" && a + 1 < argc) threads = atoi(argv[++a]);
+        else if (arg == "--binary" && a + 1 < argc) binaryPath = argv[++a];
+        else if (arg == "--batch" && a + 1 < argc) batchSource = argv[++a];
+        else if (arg == "--max-errors" && a + 1 < argc) errorBudget.limit = atol(argv[++a]);
+        else if (arg == "--scan" && a + 1 < argc) {
+            if (!selectScanKernels(argv[++a])) cerr << "Unknown or unsupported scan kernels " << argv[a] << "\n";
+        }
+        else filename = arg;
+    }
+    activeBudget = &errorBudget;  // this thread lexes in file order
+    LEX_STATS_PROGRAM("lab1", tokenKindNames);
+    if (!batchSource.empty()) {
+        processBatch(batchSource, threads);
+        return 0;
+    }
+    if (filename.empty()) {
+        cout << "Enter the filename to analyze: ";
+        cin >> filename;
+    }
 
-    processFile(filename);
+    if (threads > 0) processFileParallel(filename, threads);
+    else if (!binaryPath.empty()) processFileMapped(filename);
+    else processFile(filename);
     return 0;
 }
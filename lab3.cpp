@@ -11,17 +11,60 @@ unordered_set<string> multiOp = {"==","!=","<=",">=","++","--","+=","-=","*=","/
 // Special Symbols
 unordered_set<char> special = {')','(','{','}',';',','};
 
+// Lexemes are interned once into large blocks; entries only hold views
+struct LexemeArena {
+    vector<unique_ptr<char[]>> blocks;
+    size_t used = 0, capacity = 0;
+
+    string_view intern(string_view s) {
+        if (used + s.size() > capacity) {
+            capacity = max<size_t>(1 << 16, s.size());
+            blocks.emplace_back(new char[capacity]);
+            used = 0;
+        }
+        char *dst = blocks.back().get() + used;
+        memcpy(dst, s.data(), s.size());
+        used += s.size();
+        return string_view(dst, s.size());
+    }
+};
+
 // Symbol Table Entry
 struct SymbolEntry {
     int entryNo;
-    string lexeme;
-    string tokenType;
+    string_view lexeme;     // interned in lexemeArena
+    string_view tokenType;  // interned in lexemeArena
     int lineDeclared;
     vector<int> lineUsed;
 };
 
-// Symbol Table
+// Symbol Table (entryNo order)
 vector<SymbolEntry> symbolTable;
+LexemeArena lexemeArena;
+
+// Open-addressing hash index over symbolTable.
+// A slot holds entry index + 1 (0 = empty); the size is always a power of two.
+vector<int> symbolIndex(1024, 0);
+vector<size_t> symbolHash; // hash of each entry, reused when the index grows
+
+size_t hashSymbol(string_view lexeme, string_view type) {
+    size_t h = 14695981039346656037ULL; // FNV-1a
+    for (char ch : lexeme) { h ^= (unsigned char)ch; h *= 1099511628211ULL; }
+    h ^= 0xff; h *= 1099511628211ULL;
+    for (char ch : type) { h ^= (unsigned char)ch; h *= 1099511628211ULL; }
+    return h ^ (h >> 29);
+}
+
+void growSymbolIndex() {
+    vector<int> bigger(symbolIndex.size() * 2, 0);
+    size_t mask = bigger.size() - 1;
+    for (size_t e = 0; e < symbolTable.size(); e++) {
+        size_t slot = symbolHash[e] & mask;
+        while (bigger[slot]) slot = (slot + 1) & mask;
+        bigger[slot] = e + 1;
+    }
+    symbolIndex.swap(bigger);
+}
 
 // Check keyword
 bool isKeyword(string s) {
@@ -37,22 +80,31 @@ bool isIdentifierChar(char c) {
 }
 
 // Add to symbol table
-void addToSymbolTable(string lexeme, string type, int line) {
-    // check for existing entry
-    for (auto &e : symbolTable) {
-        if (e.lexeme == lexeme && e.tokenType == type) {
+void addToSymbolTable(string_view lexeme, string_view type, int line) {
+    // check for existing entry (linear probing)
+    size_t h = hashSymbol(lexeme, type);
+    size_t mask = symbolIndex.size() - 1;
+    size_t slot = h & mask;
+    while (int idx = symbolIndex[slot]) {
+        SymbolEntry &e = symbolTable[idx - 1];
+        if (symbolHash[idx - 1] == h && e.lexeme == lexeme && e.tokenType == type) {
             e.lineUsed.push_back(line);
             return;
         }
+        slot = (slot + 1) & mask;
     }
     // add new entry
     SymbolEntry newEntry;
     newEntry.entryNo = symbolTable.size() + 1;
-    newEntry.lexeme = lexeme;
-    newEntry.tokenType = type;
+    newEntry.lexeme = lexemeArena.intern(lexeme);
+    newEntry.tokenType = lexemeArena.intern(type);
     newEntry.lineDeclared = line;
     newEntry.lineUsed.push_back(line);
-    symbolTable.push_back(newEntry);
+    symbolTable.push_back(move(newEntry));
+    symbolHash.push_back(h);
+    symbolIndex[slot] = symbolTable.size();
+    // keep the load factor under 1/2
+    if (symbolTable.size() * 2 > symbolIndex.size()) growSymbolIndex();
 }
 
 // main processing function